@@ -25,6 +25,8 @@
 #define __P_DBF_H__
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include <string>
 #include <vector>
 #include <map>
@@ -34,8 +36,8 @@
 #define MMax(a, b) ( (a)>(b) ? (a):(b) )
 #define MMin(a, b) ( (a)<(b) ? (a):(b) )
 
-// DBFӿ
-class CIDbf
+// DBF壬뼰ַ
+class CDbfBase
 {
 public:
     // 
@@ -46,7 +48,43 @@ public:
         DBF_FILE_ERROR,     // ļ
         DBF_PARA_ERROR,     // 
         DBF_CACHE_ERROR,    // 
+        DBF_OVERFLOW_ERROR, // ¼ļͷ32λ
     };
+    // ַ
+    static std::string Ltrim(const std::string& s)
+    {
+        size_t nPos = 0;
+        for (nPos = 0; nPos < s.size(); nPos++)
+        {
+            if (!isspace(s[nPos]))
+            {
+                break;
+            }
+        }
+        return s.substr(nPos);
+    }
+    static std::string Rtrim(const std::string& s)
+    {
+        size_t nPos = 0;
+        for (nPos = s.size(); nPos > 0; nPos--)
+        {
+            if (!isspace(s[nPos - 1]))
+            {
+                break;
+            }
+        }
+        return s.substr(0, nPos);
+    }
+    static std::string Trim(const std::string& s)
+    {
+        return Ltrim(Rtrim(s));
+    }
+};
+
+// DBFӿ
+class CIDbf : public CDbfBase
+{
+public:
     // жļǷ
     virtual bool IsOpen() = 0;
 
@@ -71,9 +109,9 @@ public:
     // 洦ܸ
     // ȡļ¼
     // ȡ¼е
-    virtual int Read(int nRecNo, int nRecNum) = 0;
+    virtual int Read(size_t nRecNo, size_t nRecNum) = 0;
     // öָ, 0ʼ, ¼
-    virtual int ReadGo(int nRec) = 0;
+    virtual int ReadGo(size_t nRec) = 0;
     // ȡֶ
     virtual std::string ReadString(const std::string& strName) = 0;
     virtual double ReadDouble(const std::string& strName) = 0;
@@ -98,7 +136,7 @@ public:
     // ύдݵļ
     virtual int FileCommit() = 0;
     // дָ, 0ʼ, ¼
-    virtual int WriteGo(int nRec) = 0;
+    virtual int WriteGo(size_t nRec) = 0;
     // ֶдֶ
     virtual int WriteString(const std::string& strName, const std::string& strValue) = 0;
     virtual int WriteDouble(const std::string& strName, double fValue) = 0;
@@ -110,35 +148,6 @@ public:
     virtual int WriteInt(size_t nCol, int nValue) = 0;
     virtual int WriteLong(size_t nCol, long nValue) = 0;
 
-    // ַ
-    static std::string Ltrim(const std::string& s)
-    {
-        size_t nPos = 0;
-        for (nPos = 0; nPos < s.size(); nPos++)
-        {
-            if (!isspace(s[nPos]))
-            {
-                break;
-            }
-        }
-        return s.substr(nPos);
-    }
-    static std::string Rtrim(const std::string& s)
-    {
-        size_t nPos = 0;
-        for (nPos = s.size(); nPos > 0; nPos--)
-        {
-            if (!isspace(s[nPos - 1]))
-            {
-                break;
-            }
-        }
-        return s.substr(0, nPos);
-    }
-    static std::string Trim(const std::string& s)
-    {
-        return Ltrim(Rtrim(s));
-    }
 public:
     virtual ~CIDbf() {}
 
@@ -225,23 +234,266 @@ public:
         cMdxFlag = 0;
     }
 };
+// ֵֶ׷ʱʹãֻõ÷ݲ
+class TDbfValue
+{
+public:
+    const char* pData;  // ֶ
+    size_t nLen;        // ݳȣֶγʱضϣʱո
+
+    TDbfValue()
+    {
+        pData = NULL;
+        nLen = 0;
+    }
+    TDbfValue(const char* pValue, size_t nValueLen)
+    {
+        pData = pValue;
+        nLen = nValueLen;
+    }
+    TDbfValue(const char* pValue)
+    {
+        pData = pValue;
+        nLen = pValue ? strlen(pValue) : 0;
+    }
+    TDbfValue(const std::string& strValue)
+    {
+        pData = strValue.data();
+        nLen = strValue.size();
+    }
+};
+// ڴʹõĻ
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <malloc.h>
+class CDbfMutex
+{
+public:
+    CDbfMutex() { InitializeCriticalSection(&m_oLock); }
+    ~CDbfMutex() { DeleteCriticalSection(&m_oLock); }
+    void Lock() { EnterCriticalSection(&m_oLock); }
+    void Unlock() { LeaveCriticalSection(&m_oLock); }
+private:
+    CDbfMutex(const CDbfMutex&);
+    CDbfMutex& operator=(const CDbfMutex&);
+    CRITICAL_SECTION m_oLock;
+};
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+class CDbfMutex
+{
+public:
+    CDbfMutex() { pthread_mutex_init(&m_oLock, NULL); }
+    ~CDbfMutex() { pthread_mutex_destroy(&m_oLock); }
+    void Lock() { pthread_mutex_lock(&m_oLock); }
+    void Unlock() { pthread_mutex_unlock(&m_oLock); }
+private:
+    CDbfMutex(const CDbfMutex&);
+    CDbfMutex& operator=(const CDbfMutex&);
+    pthread_mutex_t m_oLock;
+};
+#endif
+
+// ¼ڴ
+// 2ݴηּͷŵڴ飬64ֽڶ룻ôҳʱ2MϵڴʹMAP_HUGETLB
+// ϵͳδԤҳʱ˻ͨӳ䲢ںʹ͸ҳڶCPDbf乲
+class CDbfBufPool
+{
+public:
+    enum
+    {
+        ALIGN_SIZE = 64,                    // ֽ
+        MIN_BLOCK_SIZE = 4096,              // Сڴ
+        HUGE_PAGE_SIZE = 2 * 1024 * 1024,   // ҳС
+        MAX_LEVEL = 48,                     // ڴּ
+    };
+
+    // nMaxCacheSizeΪĿڴޣʱֱͷ
+    CDbfBufPool(bool bHugePage = false, size_t nMaxCacheSize = 256 * 1024 * 1024)
+    {
+        m_bHugePage = bHugePage;
+        m_nMaxCacheSize = nMaxCacheSize;
+        m_nCacheSize = 0;
+        m_nAllocNum = 0;
+    }
+    ~CDbfBufPool()
+    {
+        Clear();
+    }
+
+    // 벻СnSizeֽڵڴ棬nCapacityʵʴСͷʱ贫
+    char* Alloc(size_t nSize, size_t& nCapacity)
+    {
+        size_t nLevel = Level(nSize);
+        nCapacity = (size_t)MIN_BLOCK_SIZE << nLevel;
+        if (nCapacity < nSize)
+        {
+            nCapacity = 0;
+            return NULL;
+        }
+        m_oLock.Lock();
+        std::vector<char*>& vecFree = m_vecFree[nLevel];
+        if (!vecFree.empty())
+        {
+            char* pBuf = vecFree.back();
+            vecFree.pop_back();
+            m_nCacheSize -= nCapacity;
+            m_oLock.Unlock();
+            return pBuf;
+        }
+        m_nAllocNum++;
+        m_oLock.Unlock();
+        return SysAlloc(nCapacity);
+    }
+    // 黹ڴ
+    void Free(char* pBuf, size_t nCapacity)
+    {
+        if (!pBuf)
+        {
+            return;
+        }
+        m_oLock.Lock();
+        if (m_nCacheSize + nCapacity <= m_nMaxCacheSize)
+        {
+            m_vecFree[Level(nCapacity)].push_back(pBuf);
+            m_nCacheSize += nCapacity;
+            pBuf = NULL;
+        }
+        m_oLock.Unlock();
+        if (pBuf)
+        {
+            SysFree(pBuf, nCapacity);
+        }
+    }
+    // ͷŻĿڴ
+    void Clear()
+    {
+        m_oLock.Lock();
+        for (size_t i = 0; i < MAX_LEVEL; i++)
+        {
+            for (size_t j = 0; j < m_vecFree[i].size(); j++)
+            {
+                SysFree(m_vecFree[i][j], (size_t)MIN_BLOCK_SIZE << i);
+            }
+            m_vecFree[i].clear();
+        }
+        m_nCacheSize = 0;
+        m_oLock.Unlock();
+    }
+
+    // ĿڴС
+    inline size_t GetCacheSize() const { return m_nCacheSize; }
+    // ϵͳڴĴ
+    inline size_t GetAllocNum() const { return m_nAllocNum; }
+
+private:
+    CDbfBufPool(const CDbfBufPool&);
+    CDbfBufPool& operator=(const CDbfBufPool&);
+
+    // ڴ鼶nSizeȡMIN_BLOCK_SIZE2ݴα
+    static size_t Level(size_t nSize)
+    {
+        size_t nLevel = 0;
+        size_t nBlock = MIN_BLOCK_SIZE;
+        while (nBlock < nSize && nBlock <= ((size_t)-1 >> 1) && nLevel + 1 < MAX_LEVEL)
+        {
+            nBlock <<= 1;
+            nLevel++;
+        }
+        return nLevel;
+    }
+    inline bool UseHugePage(size_t nCapacity) const
+    {
+        return m_bHugePage && nCapacity >= HUGE_PAGE_SIZE;
+    }
+
+    char* SysAlloc(size_t nCapacity)
+    {
+#ifdef _WIN32
+        return (char*)_aligned_malloc(nCapacity, ALIGN_SIZE);
+#else
+        void* pBuf = NULL;
+        if (UseHugePage(nCapacity))
+        {
+#ifdef MAP_HUGETLB
+            pBuf = mmap(NULL, nCapacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (pBuf != MAP_FAILED)
+            {
+                return (char*)pBuf;
+            }
+#endif
+            pBuf = mmap(NULL, nCapacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (pBuf == MAP_FAILED)
+            {
+                return NULL;
+            }
+#ifdef MADV_HUGEPAGE
+            madvise(pBuf, nCapacity, MADV_HUGEPAGE);
+#endif
+            return (char*)pBuf;
+        }
+        if (posix_memalign(&pBuf, ALIGN_SIZE, nCapacity))
+        {
+            return NULL;
+        }
+        return (char*)pBuf;
+#endif
+    }
+    void SysFree(char* pBuf, size_t nCapacity)
+    {
+#ifdef _WIN32
+        (void)nCapacity;
+        _aligned_free(pBuf);
+#else
+        if (UseHugePage(nCapacity))
+        {
+            munmap(pBuf, nCapacity);
+            return;
+        }
+        free(pBuf);
+#endif
+    }
+
+private:
+    // Ƿʹôҳ
+    bool m_bHugePage;
+    // ڴ滺
+    size_t m_nMaxCacheSize;
+    // ǰĿڴ
+    size_t m_nCacheSize;
+    // ϵͳڴĴ
+    size_t m_nAllocNum;
+    // ڴ
+    std::vector<char*> m_vecFree[MAX_LEVEL];
+    CDbfMutex m_oLock;
+};
+
 // ¼л
+// ڴpPool(Ϊʱֱnew)Ԥ䣬дʱгʼΪո
 class CRecordBuf
 {
 public:
-    CRecordBuf(size_t nRecCapacity, size_t nRecLen)
+    CRecordBuf(size_t nRecCapacity, size_t nRecLen, CDbfBufPool* pPool = NULL)
     {
         m_nRecNum = 0;
-        m_nRecCapacity = nRecCapacity;
+        m_nRecCapacity = 0;
         m_nRecLen = nRecLen;
-        size_t nSize = m_nRecCapacity * m_nRecLen;
-        m_pBuf = new char[nSize];
-        memset(m_pBuf, ' ', nSize);
+        m_pBuf = NULL;
+        m_nBufSize = 0;
+        m_pPool = pPool;
         m_nCurRec = 0;
+        Reserve(nRecCapacity);
     }
     ~CRecordBuf()
     {
-        delete[] m_pBuf;
+        FreeBuf(m_pBuf, m_nBufSize);
         m_pBuf = NULL;
     }
 
@@ -290,17 +542,38 @@ public:
         {
             m_nRecNum = nNum;
         }
-        // 
+        // 󣬱м¼
         if (nNum > m_nRecCapacity)
         {
-            char* pBuf = new char[nNum * m_nRecLen];
-            memset(pBuf, 0, nNum * m_nRecLen);
-            memcpy(pBuf, m_pBuf, m_nRecCapacity*m_nRecLen);
-            m_nRecCapacity = nNum;
+            size_t nBufSize = 0;
+            char* pBuf = AllocBuf(nNum * m_nRecLen, nBufSize);
+            if (!pBuf)
+            {
+                return;
+            }
+            if (m_nRecNum)
+            {
+                memcpy(pBuf, m_pBuf, m_nRecNum * m_nRecLen);
+            }
             // ڴ洦
-            delete m_pBuf;
+            FreeBuf(m_pBuf, m_nBufSize);
             m_pBuf = pBuf;
+            m_nBufSize = nBufSize;
+            m_nRecCapacity = m_nRecLen ? m_nBufSize / m_nRecLen : nNum;
+        }
+    }
+    // ֤nNum¼ʱ룬м¼
+    void Reserve(size_t nNum)
+    {
+        if (nNum <= m_nRecCapacity && m_pBuf)
+        {
+            return;
         }
+        FreeBuf(m_pBuf, m_nBufSize);
+        m_pBuf = AllocBuf(nNum * m_nRecLen, m_nBufSize);
+        m_nRecCapacity = m_nRecLen ? m_nBufSize / m_nRecLen : nNum;
+        m_nRecNum = 0;
+        m_nCurRec = 0;
     }
 
     // ǷΪ
@@ -323,7 +596,7 @@ public:
         m_nCurRec = nRec;
         return true;
     }
-    // õǰУ0ʼ
+    // õǰУ0ʼгʼΪո
     inline bool WriteGo(size_t nRec)
     {
         if (nRec >= m_nRecCapacity)
@@ -331,7 +604,11 @@ public:
             return false;
         }
         m_nCurRec = nRec;
-        m_nRecNum = MMax(nRec + 1, m_nRecNum);
+        if (nRec >= m_nRecNum)
+        {
+            memset(m_pBuf + m_nRecNum * m_nRecLen, ' ', (nRec + 1 - m_nRecNum) * m_nRecLen);
+            m_nRecNum = nRec + 1;
+        }
         return true;
     }
     inline void WriteReset()
@@ -339,6 +616,20 @@ public:
         m_nCurRec = 0;
         m_nRecNum = 0;
     }
+    // м¼׷nNumУеַʱNULLвʼ
+    inline char* AppendRec(size_t nNum)
+    {
+        if (nNum > m_nRecCapacity - m_nRecNum)
+        {
+            return NULL;
+        }
+        char* pRec = m_pBuf + m_nRecNum * m_nRecLen;
+        m_nRecNum += nNum;
+        m_nCurRec = m_nRecNum - 1;
+        return pRec;
+    }
+    // ɼ¼
+    inline size_t RecCapacity() { return m_nRecCapacity; }
     // ȡǰ
     char* GetCurRow()
     {
@@ -349,6 +640,41 @@ public:
     inline char* Data() { return m_pBuf; }
     inline size_t& RecNum() { return m_nRecNum; }
     inline size_t  RecLen() { return m_nRecLen; }
+private:
+    CRecordBuf(const CRecordBuf&);
+    CRecordBuf& operator=(const CRecordBuf&);
+
+    char* AllocBuf(size_t nSize, size_t& nBufSize)
+    {
+        if (m_pPool)
+        {
+            char* pBuf = m_pPool->Alloc(nSize, nBufSize);
+            if (!pBuf)
+            {
+                nBufSize = 0;
+            }
+            return pBuf;
+        }
+        // һֽڣ֤Data()ǿ
+        nBufSize = MMax(nSize, (size_t)1);
+        return new char[nBufSize];
+    }
+    void FreeBuf(char* pBuf, size_t nBufSize)
+    {
+        if (!pBuf)
+        {
+            return;
+        }
+        if (m_pPool)
+        {
+            m_pPool->Free(pBuf, nBufSize);
+        }
+        else
+        {
+            delete[] pBuf;
+        }
+    }
+
 private:
     // ǰ¼
     size_t m_nRecNum;
@@ -358,12 +684,18 @@ private:
     size_t m_nRecCapacity;
     // 
     char* m_pBuf;
+    // ڴС
+    size_t m_nBufSize;
+    // ڴ
+    CDbfBufPool* m_pPool;
     // ǰ
     size_t m_nCurRec;
 };
 
 // ƽ̨
 #ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
 int ws_fopen(FILE** _Stream, char const* _FileName, char const* _Mode)
 {
     return fopen_s(_Stream, _FileName, _Mode);
@@ -372,7 +704,30 @@ int ws_localtime(struct tm* const _Tm, time_t const* const _Time)
 {
     return localtime_s(_Tm, _Time);
 }
+int ws_ftruncate(FILE* _Stream, unsigned long long _Size)
+{
+    fflush(_Stream);
+    return _chsize_s(_fileno(_Stream), (long long)_Size);
+}
+// 64λƫƣfseeklongWindowsΪ32λ
+int ws_fseek(FILE* _Stream, unsigned long long _Offset, int _Origin)
+{
+    return _fseeki64(_Stream, (long long)_Offset, _Origin);
+}
+int ws_fstat(FILE* _Stream, unsigned long long* _Size, long long* _MTime)
+{
+    struct _stat64 oStat;
+    if (_fstat64(_fileno(_Stream), &oStat))
+    {
+        return -1;
+    }
+    *_Size = oStat.st_size;
+    *_MTime = (long long)oStat.st_mtime * 1000000000LL;
+    return 0;
+}
 #else
+#include <unistd.h>
+#include <sys/stat.h>
 int ws_fopen(FILE** _Stream, char const* _FileName, char const* _Mode)
 {
     *_Stream = fopen(_FileName, _Mode);
@@ -387,42 +742,928 @@ int ws_localtime(struct tm* const _Tm, time_t const* const _Time)
     *_Tm = *localtime(_Time);
     return 0;
 }
+int ws_ftruncate(FILE* _Stream, unsigned long long _Size)
+{
+    if ((unsigned long long)(off_t)_Size != _Size)
+    {
+        return -1;
+    }
+    fflush(_Stream);
+    return ftruncate(fileno(_Stream), (off_t)_Size);
+}
+// 64λƫƣ32λϵͳ_FILE_OFFSET_BITS=64룬򳬹off_tΧƫƷʧ
+int ws_fseek(FILE* _Stream, unsigned long long _Offset, int _Origin)
+{
+    if ((unsigned long long)(off_t)_Offset != _Offset)
+    {
+        return -1;
+    }
+    return fseeko(_Stream, (off_t)_Offset, _Origin);
+}
+int ws_fstat_fd(int _Fd, unsigned long long* _Size, long long* _MTime)
+{
+    struct stat oStat;
+    if (fstat(_Fd, &oStat))
+    {
+        return -1;
+    }
+    *_Size = oStat.st_size;
+#ifdef __linux__
+    *_MTime = (long long)oStat.st_mtim.tv_sec * 1000000000LL + oStat.st_mtim.tv_nsec;
+#else
+    *_MTime = (long long)oStat.st_mtime * 1000000000LL;
+#endif
+    return 0;
+}
+int ws_fstat(FILE* _Stream, unsigned long long* _Size, long long* _MTime)
+{
+    return ws_fstat_fd(fileno(_Stream), _Size, _MTime);
+}
 #define sprintf_s sprintf
 #endif
 
-class CPDbf : public CIDbf
+// I/OͳƣͨBasicDbf::SetStatsãδʱֻһָж
+// (C++98ʹԭӱ)ֻʹøö߳жȡڸ߳̽ȡ
+// ̸߳һͳƶ󣬽Add
+class TDbfStats
 {
 public:
-    // 캯
-    CPDbf()
-        :m_cBlank(' ')
+    unsigned long long nReadBytes;      // ȡֽ
+    unsigned long long nWriteBytes;     // дֽ
+    unsigned long long nSeekNum;        // fseek
+    unsigned long long nReadNum;        // ô
+    unsigned long long nWriteNum;       // дô
+    unsigned long long nReadBatch;      // Read
+    unsigned long long nWriteBatch;     // WriteCommit
+    unsigned long long nRealloc;        // д
+    unsigned long long nFindField;      // ֶҴ
+    unsigned long long nParseNum;       // ֵʽ
+    long long nIoNs;                    // дۼƺʱ()
+    long long nDecodeNs;                // ʽۼƺʱ()
+    bool bTiming;                       // Ƿʱرպֻ
+
+    TDbfStats()
+    {
+        bTiming = true;
+        Reset();
+    }
+    void Reset()
+    {
+        nReadBytes = 0;
+        nWriteBytes = 0;
+        nSeekNum = 0;
+        nReadNum = 0;
+        nWriteNum = 0;
+        nReadBatch = 0;
+        nWriteBatch = 0;
+        nRealloc = 0;
+        nFindField = 0;
+        nParseNum = 0;
+        nIoNs = 0;
+        nDecodeNs = 0;
+    }
+    // ۼһͳƶļ
+    void Add(const TDbfStats& oOther)
+    {
+        nReadBytes += oOther.nReadBytes;
+        nWriteBytes += oOther.nWriteBytes;
+        nSeekNum += oOther.nSeekNum;
+        nReadNum += oOther.nReadNum;
+        nWriteNum += oOther.nWriteNum;
+        nReadBatch += oOther.nReadBatch;
+        nWriteBatch += oOther.nWriteBatch;
+        nRealloc += oOther.nRealloc;
+        nFindField += oOther.nFindField;
+        nParseNum += oOther.nParseNum;
+        nIoNs += oOther.nIoNs;
+        nDecodeNs += oOther.nDecodeNs;
+    }
+
+    // ʱ()
+    static long long Now()
+    {
+#ifdef _WIN32
+        LARGE_INTEGER nFreq, nCount;
+        QueryPerformanceFrequency(&nFreq);
+        QueryPerformanceCounter(&nCount);
+        return (long long)((double)nCount.QuadPart * 1e9 / nFreq.QuadPart);
+#else
+        struct timespec tNow;
+        clock_gettime(CLOCK_MONOTONIC, &tNow);
+        return (long long)tNow.tv_sec * 1000000000LL + tNow.tv_nsec;
+#endif
+    }
+    // ʱ㣬رռʱʱȡʱ
+    inline long long Start() const { return bTiming ? Now() : 0; }
+    inline long long Since(long long nStart) const { return bTiming ? Now() - nStart : 0; }
+};
+
+// ļ洢ʹstdioд
+class CDbfStdioFile
+{
+public:
+    CDbfStdioFile()
     {
-        // ļ
         m_pFile = NULL;
-        // עϢ
-        m_nRemarkLen = 0;
-        // ǰ
-        m_nCurRec = 0;
-        // ļл
-        m_pWriteBuf = NULL;
-        m_pReadBuf = NULL;
-        m_bReadOnly = true;
-        // ȡǰ
-        int nY = 0, nM = 0, nD = 0;
-        GetCurDate(nY, nM, nD);
-        m_cYear = nY;
-        m_cMonth = nM;
-        m_cDay = nD;
     }
-    ~CPDbf()
+    ~CDbfStdioFile()
     {
         Close();
     }
 
-    // жļǷ
-    inline bool IsOpen() { return m_pFile != NULL; }
+    inline bool IsOpen() const { return m_pFile != NULL; }
+    inline bool IsInMemory() const { return false; }
+    // ÿζдǷҪfseek
+    inline bool NeedSeek() const { return true; }
 
-    // ļ
+    // ļ
+    int Open(const std::string& strFile, bool bReadOnly)
+    {
+        Close();
+        if (ws_fopen(&m_pFile, strFile.c_str(), bReadOnly ? "rb" : "rb+"))
+        {
+            m_pFile = NULL;
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return CIDbf::DBF_SUCC;
+    }
+    // ½ļѴʱ
+    int Create(const std::string& strFile)
+    {
+        Close();
+        if (ws_fopen(&m_pFile, strFile.c_str(), "wb+"))
+        {
+            m_pFile = NULL;
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return CIDbf::DBF_SUCC;
+    }
+    void Close()
+    {
+        if (m_pFile)
+        {
+            fclose(m_pFile);
+            m_pFile = NULL;
+        }
+    }
+
+    // ļƫƶдʵʶдֽ
+    size_t ReadAt(unsigned long long nOffset, void* ptr, size_t nSize)
+    {
+        if (ws_fseek(m_pFile, nOffset, SEEK_SET))
+        {
+            return 0;
+        }
+        return fread(ptr, 1, nSize, m_pFile);
+    }
+    size_t WriteAt(unsigned long long nOffset, const void* ptr, size_t nSize)
+    {
+        if (ws_fseek(m_pFile, nOffset, SEEK_SET))
+        {
+            return 0;
+        }
+        return fwrite(ptr, 1, nSize, m_pFile);
+    }
+    // ޸ļС
+    int Truncate(unsigned long long nSize)
+    {
+        return ws_ftruncate(m_pFile, nSize) ? CIDbf::DBF_FILE_ERROR : CIDbf::DBF_SUCC;
+    }
+    // дˢµϵͳ
+    int Flush()
+    {
+        return fflush(m_pFile) ? CIDbf::DBF_FILE_ERROR : CIDbf::DBF_SUCC;
+    }
+    // 棬ʹ̵޸Ŀɼ(glibcڻ淶Χfseekʱᶪ)
+    void DropCache()
+    {
+        fflush(m_pFile);
+    }
+    // ļС޸ʱ()
+    int Stat(unsigned long long& nSize, long long& nMTime)
+    {
+        return ws_fstat(m_pFile, &nSize, &nMTime) ? CIDbf::DBF_FILE_ERROR : CIDbf::DBF_SUCC;
+    }
+
+private:
+    CDbfStdioFile(const CDbfStdioFile&);
+    CDbfStdioFile& operator=(const CDbfStdioFile&);
+
+    FILE* m_pFile;
+};
+
+// ڴ洢ļһڴУSaveʱһ˳дļ
+// ֻʱд롢ضϼSaveʧ
+class CDbfMemFile
+{
+public:
+    CDbfMemFile()
+    {
+        m_bOpen = false;
+        m_bReadOnly = false;
+    }
+
+    inline bool IsOpen() const { return m_bOpen; }
+    inline bool IsInMemory() const { return true; }
+    inline bool NeedSeek() const { return false; }
+
+    // ļ
+    int Open(const std::string& strFile, bool bReadOnly)
+    {
+        Close();
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strFile.c_str(), "rb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        int nRet = CIDbf::DBF_SUCC;
+        std::vector<char> vecData;
+        char szBuf[64 * 1024];
+        size_t nRead = 0;
+        while ((nRead = fread(szBuf, 1, sizeof(szBuf), pFile)) > 0)
+        {
+            vecData.insert(vecData.end(), szBuf, szBuf + nRead);
+        }
+        if (ferror(pFile))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        fclose(pFile);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            m_vecData.swap(vecData);
+            m_bOpen = true;
+            m_bReadOnly = bReadOnly;
+        }
+        return nRet;
+    }
+    // ʹеļӳ
+    int Open(std::vector<char>& vecImage, bool bReadOnly = false)
+    {
+        Close();
+        m_vecData.swap(vecImage);
+        m_bOpen = true;
+        m_bReadOnly = bReadOnly;
+        return CIDbf::DBF_SUCC;
+    }
+    int Create(const std::string& /*strFile*/)
+    {
+        Close();
+        m_bOpen = true;
+        m_bReadOnly = false;
+        return CIDbf::DBF_SUCC;
+    }
+    void Close()
+    {
+        std::vector<char>().swap(m_vecData);
+        m_bOpen = false;
+    }
+
+    size_t ReadAt(unsigned long long nOffset, void* ptr, size_t nSize)
+    {
+        if (nOffset >= m_vecData.size())
+        {
+            return 0;
+        }
+        nSize = MMin(nSize, m_vecData.size() - (size_t)nOffset);
+        memcpy(ptr, &m_vecData[(size_t)nOffset], nSize);
+        return nSize;
+    }
+    // ǰСʱݣַռʱʧ
+    size_t WriteAt(unsigned long long nOffset, const void* ptr, size_t nSize)
+    {
+        if (m_bReadOnly || nOffset + nSize > m_vecData.max_size())
+        {
+            return 0;
+        }
+        if (nOffset + nSize > m_vecData.size())
+        {
+            if (nOffset + nSize > m_vecData.capacity())
+            {
+                m_vecData.reserve(MMax((size_t)nOffset + nSize, m_vecData.capacity() * 2));
+            }
+            m_vecData.resize((size_t)nOffset + nSize);
+        }
+        if (nSize)
+        {
+            memcpy(&m_vecData[(size_t)nOffset], ptr, nSize);
+        }
+        return nSize;
+    }
+    int Truncate(unsigned long long nSize)
+    {
+        if (m_bReadOnly || nSize > m_vecData.max_size())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_vecData.resize((size_t)nSize);
+        return CIDbf::DBF_SUCC;
+    }
+    int Flush()
+    {
+        return CIDbf::DBF_SUCC;
+    }
+    void DropCache()
+    {
+    }
+    int Stat(unsigned long long& nSize, long long& nMTime)
+    {
+        nSize = m_vecData.size();
+        nMTime = 0;
+        return CIDbf::DBF_SUCC;
+    }
+
+    // һ˳дļ
+    int Save(const std::string& strFile)
+    {
+        if (m_bReadOnly)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strFile.c_str(), "wb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        int nRet = CIDbf::DBF_SUCC;
+        if (!m_vecData.empty() && fwrite(&m_vecData[0], 1, m_vecData.size(), pFile) != m_vecData.size())
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        if (fclose(pFile))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        return nRet;
+    }
+
+    inline const char* Data() const { return m_vecData.empty() ? NULL : &m_vecData[0]; }
+    inline size_t Size() const { return m_vecData.size(); }
+
+private:
+    bool m_bOpen;
+    bool m_bReadOnly;
+    std::vector<char> m_vecData;
+};
+
+// CPDbfʹõĴ洢ͨļģʽڴģʽ
+class CDbfFile
+{
+public:
+    CDbfFile()
+    {
+        m_bInMemory = false;
+    }
+
+    inline bool IsOpen() const { return m_bInMemory ? m_oMem.IsOpen() : m_oFile.IsOpen(); }
+    inline bool IsInMemory() const { return m_bInMemory; }
+    inline bool NeedSeek() const { return !m_bInMemory; }
+
+    int Open(const std::string& strFile, bool bReadOnly, bool bInMemory = false)
+    {
+        Close();
+        m_bInMemory = bInMemory;
+        return m_bInMemory ? m_oMem.Open(strFile, bReadOnly) : m_oFile.Open(strFile, bReadOnly);
+    }
+    int Open(std::vector<char>& vecImage, bool bReadOnly = false)
+    {
+        Close();
+        m_bInMemory = true;
+        return m_oMem.Open(vecImage, bReadOnly);
+    }
+    int Create(const std::string& strFile, bool bInMemory = false)
+    {
+        Close();
+        m_bInMemory = bInMemory;
+        return m_bInMemory ? m_oMem.Create(strFile) : m_oFile.Create(strFile);
+    }
+    void Close()
+    {
+        m_oFile.Close();
+        m_oMem.Close();
+    }
+    inline size_t ReadAt(unsigned long long nOffset, void* ptr, size_t nSize)
+    {
+        return m_bInMemory ? m_oMem.ReadAt(nOffset, ptr, nSize) : m_oFile.ReadAt(nOffset, ptr, nSize);
+    }
+    inline size_t WriteAt(unsigned long long nOffset, const void* ptr, size_t nSize)
+    {
+        return m_bInMemory ? m_oMem.WriteAt(nOffset, ptr, nSize) : m_oFile.WriteAt(nOffset, ptr, nSize);
+    }
+    int Truncate(unsigned long long nSize)
+    {
+        return m_bInMemory ? m_oMem.Truncate(nSize) : m_oFile.Truncate(nSize);
+    }
+    int Flush()
+    {
+        return m_bInMemory ? m_oMem.Flush() : m_oFile.Flush();
+    }
+    void DropCache()
+    {
+        m_bInMemory ? m_oMem.DropCache() : m_oFile.DropCache();
+    }
+    int Stat(unsigned long long& nSize, long long& nMTime)
+    {
+        return m_bInMemory ? m_oMem.Stat(nSize, nMTime) : m_oFile.Stat(nSize, nMTime);
+    }
+    // ڴģʽдļ
+    int Save(const std::string& strFile)
+    {
+        return m_bInMemory ? m_oMem.Save(strFile) : CIDbf::DBF_PARA_ERROR;
+    }
+
+private:
+    // ǷΪڴģʽ
+    bool m_bInMemory;
+    CDbfStdioFile m_oFile;
+    CDbfMemFile m_oMem;
+};
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <errno.h>
+// ļ洢ʹpread/pwriteƫƶдû̬棬ɶ̲߳
+class CDbfPreadFile
+{
+public:
+    CDbfPreadFile()
+    {
+        m_nFd = -1;
+    }
+    ~CDbfPreadFile()
+    {
+        Close();
+    }
+
+    inline bool IsOpen() const { return m_nFd >= 0; }
+    inline bool IsInMemory() const { return false; }
+    inline bool NeedSeek() const { return false; }
+
+    int Open(const std::string& strFile, bool bReadOnly)
+    {
+        Close();
+        m_nFd = open(strFile.c_str(), bReadOnly ? O_RDONLY : O_RDWR);
+        return m_nFd >= 0 ? CDbfBase::DBF_SUCC : CDbfBase::DBF_FILE_ERROR;
+    }
+    int Create(const std::string& strFile)
+    {
+        Close();
+        m_nFd = open(strFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        return m_nFd >= 0 ? CDbfBase::DBF_SUCC : CDbfBase::DBF_FILE_ERROR;
+    }
+    void Close()
+    {
+        if (m_nFd >= 0)
+        {
+            close(m_nFd);
+            m_nFd = -1;
+        }
+    }
+
+    size_t ReadAt(unsigned long long nOffset, void* ptr, size_t nSize)
+    {
+        if ((unsigned long long)(off_t)(nOffset + nSize) != nOffset + nSize)
+        {
+            return 0;
+        }
+        size_t nDone = 0;
+        while (nDone < nSize)
+        {
+            ssize_t nRet = pread(m_nFd, (char*)ptr + nDone, nSize - nDone, (off_t)(nOffset + nDone));
+            if (nRet < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (nRet <= 0)
+            {
+                break;
+            }
+            nDone += (size_t)nRet;
+        }
+        return nDone;
+    }
+    size_t WriteAt(unsigned long long nOffset, const void* ptr, size_t nSize)
+    {
+        if ((unsigned long long)(off_t)(nOffset + nSize) != nOffset + nSize)
+        {
+            return 0;
+        }
+        size_t nDone = 0;
+        while (nDone < nSize)
+        {
+            ssize_t nRet = pwrite(m_nFd, (const char*)ptr + nDone, nSize - nDone, (off_t)(nOffset + nDone));
+            if (nRet < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (nRet <= 0)
+            {
+                break;
+            }
+            nDone += (size_t)nRet;
+        }
+        return nDone;
+    }
+    int Truncate(unsigned long long nSize)
+    {
+        if ((unsigned long long)(off_t)nSize != nSize)
+        {
+            return CDbfBase::DBF_FILE_ERROR;
+        }
+        return ftruncate(m_nFd, (off_t)nSize) ? CDbfBase::DBF_FILE_ERROR : CDbfBase::DBF_SUCC;
+    }
+    // дֱӽϵͳ棬ɼ
+    int Flush()
+    {
+        return CDbfBase::DBF_SUCC;
+    }
+    void DropCache()
+    {
+    }
+    int Stat(unsigned long long& nSize, long long& nMTime)
+    {
+        return ws_fstat_fd(m_nFd, &nSize, &nMTime) ? CDbfBase::DBF_FILE_ERROR : CDbfBase::DBF_SUCC;
+    }
+
+private:
+    CDbfPreadFile(const CDbfPreadFile&);
+    CDbfPreadFile& operator=(const CDbfPreadFile&);
+
+    int m_nFd;
+};
+
+// ļ洢ļӳ䵽ڴ(MAP_SHARED)ȡΪڴ濽
+// д볬ļСʱչļӳ䣬ʺԶΪĳ
+class CDbfMmapFile
+{
+public:
+    CDbfMmapFile()
+    {
+        m_nFd = -1;
+        m_pData = NULL;
+        m_nSize = 0;
+        m_bReadOnly = true;
+    }
+    ~CDbfMmapFile()
+    {
+        Close();
+    }
+
+    inline bool IsOpen() const { return m_nFd >= 0; }
+    inline bool IsInMemory() const { return false; }
+    inline bool NeedSeek() const { return false; }
+
+    int Open(const std::string& strFile, bool bReadOnly)
+    {
+        Close();
+        m_bReadOnly = bReadOnly;
+        m_nFd = open(strFile.c_str(), bReadOnly ? O_RDONLY : O_RDWR);
+        if (m_nFd < 0 || Remap())
+        {
+            Close();
+            return CDbfBase::DBF_FILE_ERROR;
+        }
+        return CDbfBase::DBF_SUCC;
+    }
+    int Create(const std::string& strFile)
+    {
+        Close();
+        m_bReadOnly = false;
+        m_nFd = open(strFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        return m_nFd >= 0 ? CDbfBase::DBF_SUCC : CDbfBase::DBF_FILE_ERROR;
+    }
+    void Close()
+    {
+        Map(0);
+        if (m_nFd >= 0)
+        {
+            close(m_nFd);
+            m_nFd = -1;
+        }
+    }
+
+    size_t ReadAt(unsigned long long nOffset, void* ptr, size_t nSize)
+    {
+        // ӳ䷶ΧʱļǷѱչ
+        if (nOffset + nSize > m_nSize)
+        {
+            Remap();
+        }
+        if (nOffset >= m_nSize)
+        {
+            return 0;
+        }
+        nSize = MMin(nSize, m_nSize - (size_t)nOffset);
+        memcpy(ptr, m_pData + nOffset, nSize);
+        return nSize;
+    }
+    size_t WriteAt(unsigned long long nOffset, const void* ptr, size_t nSize)
+    {
+        if (m_bReadOnly)
+        {
+            return 0;
+        }
+        if (nOffset + nSize > m_nSize && Truncate(nOffset + nSize))
+        {
+            return 0;
+        }
+        memcpy(m_pData + nOffset, ptr, nSize);
+        return nSize;
+    }
+    // ӳڵַռڣ32λϵͳϳsize_tΧʱʧ
+    int Truncate(unsigned long long nSize)
+    {
+        if (nSize != (size_t)nSize || (unsigned long long)(off_t)nSize != nSize || ftruncate(m_nFd, (off_t)nSize))
+        {
+            return CDbfBase::DBF_FILE_ERROR;
+        }
+        return Map((size_t)nSize);
+    }
+    // MAP_SHAREDӳ޸Ķɼ
+    int Flush()
+    {
+        return CDbfBase::DBF_SUCC;
+    }
+    // ļС仯ʱӳ
+    void DropCache()
+    {
+        Remap();
+    }
+    int Stat(unsigned long long& nSize, long long& nMTime)
+    {
+        return ws_fstat_fd(m_nFd, &nSize, &nMTime) ? CDbfBase::DBF_FILE_ERROR : CDbfBase::DBF_SUCC;
+    }
+
+    // ӳļ
+    inline const char* Data() const { return m_pData; }
+    inline size_t Size() const { return m_nSize; }
+
+private:
+    CDbfMmapFile(const CDbfMmapFile&);
+    CDbfMmapFile& operator=(const CDbfMmapFile&);
+
+    // ǰļСӳ
+    int Remap()
+    {
+        unsigned long long nSize = 0;
+        long long nMTime = 0;
+        if (ws_fstat_fd(m_nFd, &nSize, &nMTime))
+        {
+            return CDbfBase::DBF_FILE_ERROR;
+        }
+        if (nSize == m_nSize)
+        {
+            return CDbfBase::DBF_SUCC;
+        }
+        if (nSize != (size_t)nSize)
+        {
+            return CDbfBase::DBF_FILE_ERROR;
+        }
+        return Map((size_t)nSize);
+    }
+    int Map(size_t nSize)
+    {
+        if (m_pData)
+        {
+            munmap(m_pData, m_nSize);
+            m_pData = NULL;
+            m_nSize = 0;
+        }
+        if (nSize == 0)
+        {
+            return CDbfBase::DBF_SUCC;
+        }
+        void* pData = mmap(NULL, nSize, m_bReadOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, m_nFd, 0);
+        if (pData == MAP_FAILED)
+        {
+            return CDbfBase::DBF_FILE_ERROR;
+        }
+        m_pData = (char*)pData;
+        m_nSize = nSize;
+        return CDbfBase::DBF_SUCC;
+    }
+
+private:
+    int m_nFd;
+    // ӳַС
+    char* m_pData;
+    size_t m_nSize;
+    bool m_bReadOnly;
+};
+#else
+// Windowsʹstdio洢
+typedef CDbfStdioFile CDbfPreadFile;
+typedef CDbfStdioFile CDbfMmapFile;
+#endif
+
+// ֶνԣʹC⺯CIDbfӿΪһ
+class CDbfDefaultParse
+{
+public:
+    static double ToDouble(const char* pField, size_t nLen)
+    {
+        char szBuf[256];
+        return atof(Copy(szBuf, pField, nLen));
+    }
+    static int ToInt(const char* pField, size_t nLen)
+    {
+        char szBuf[256];
+        return atoi(Copy(szBuf, pField, nLen));
+    }
+    static long ToLong(const char* pField, size_t nLen)
+    {
+        char szBuf[256];
+        return atol(Copy(szBuf, pField, nLen));
+    }
+    // ʽдĳ
+    static size_t FormatDouble(char* pBuf, size_t nBufSize, double fValue, int nLen, int nPrecision)
+    {
+        int nRet = snprintf(pBuf, nBufSize, "%*.*f", nLen, nPrecision, fValue);
+        return nRet < 0 ? 0 : MMin((size_t)nRet, nBufSize - 1);
+    }
+    static size_t FormatLong(char* pBuf, size_t nBufSize, long nValue)
+    {
+        int nRet = snprintf(pBuf, nBufSize, "%ld", nValue);
+        return nRet < 0 ? 0 : MMin((size_t)nRet, nBufSize - 1);
+    }
+
+protected:
+    // ֶγȲ255ΪCַ
+    static const char* Copy(char* pBuf, const char* pField, size_t nLen)
+    {
+        nLen = MMin(nLen, (size_t)255);
+        memcpy(pBuf, pField, nLen);
+        pBuf[nLen] = 0;
+        return pBuf;
+    }
+};
+
+// ֶνֱӽֶΣ
+// ֻ[ո][][.][ո]ʽʽ(ѧ)˻C⺯
+class CDbfFastParse : public CDbfDefaultParse
+{
+public:
+    static double ToDouble(const char* pField, size_t nLen)
+    {
+        const char* p = pField;
+        const char* pEnd = pField + nLen;
+        bool bNeg = false;
+        unsigned long long nMantissa = 0;
+        int nDigit = 0;
+        int nScale = 0;
+        if (!Sign(p, pEnd, bNeg))
+        {
+            return 0.0;
+        }
+        for (; p < pEnd && *p >= '0' && *p <= '9'; p++, nDigit++)
+        {
+            nMantissa = nMantissa * 10 + (*p - '0');
+        }
+        if (p < pEnd && *p == '.')
+        {
+            for (p++; p < pEnd && *p >= '0' && *p <= '9'; p++, nDigit++, nScale++)
+            {
+                nMantissa = nMantissa * 10 + (*p - '0');
+            }
+        }
+        // 15λЧֻʽʱ޷֤
+        if (nDigit > 15 || !IsBlank(p, pEnd))
+        {
+            return CDbfDefaultParse::ToDouble(pField, nLen);
+        }
+        static const double s_fPow10[] =
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+        };
+        double fValue = (double)nMantissa / s_fPow10[nScale];
+        return bNeg ? -fValue : fValue;
+    }
+    static long ToLong(const char* pField, size_t nLen)
+    {
+        const char* p = pField;
+        const char* pEnd = pField + nLen;
+        bool bNeg = false;
+        unsigned long nValue = 0;
+        if (!Sign(p, pEnd, bNeg))
+        {
+            return 0;
+        }
+        for (; p < pEnd && *p >= '0' && *p <= '9'; p++)
+        {
+            nValue = nValue * 10 + (*p - '0');
+        }
+        // atolһ£Էֺ
+        return bNeg ? -(long)nValue : (long)nValue;
+    }
+    static int ToInt(const char* pField, size_t nLen)
+    {
+        return (int)ToLong(pField, nLen);
+    }
+    static size_t FormatLong(char* pBuf, size_t nBufSize, long nValue)
+    {
+        char szTmp[32];
+        size_t nPos = sizeof(szTmp);
+        unsigned long nAbs = nValue < 0 ? 0UL - (unsigned long)nValue : (unsigned long)nValue;
+        do
+        {
+            szTmp[--nPos] = (char)('0' + nAbs % 10);
+            nAbs /= 10;
+        } while (nAbs);
+        if (nValue < 0)
+        {
+            szTmp[--nPos] = '-';
+        }
+        size_t nLen = MMin(sizeof(szTmp) - nPos, nBufSize - 1);
+        memcpy(pBuf, szTmp + nPos, nLen);
+        pBuf[nLen] = 0;
+        return nLen;
+    }
+
+private:
+    // ǰո񼰷ţȫΪոʱfalse
+    static bool Sign(const char*& p, const char* pEnd, bool& bNeg)
+    {
+        while (p < pEnd && *p == ' ')
+        {
+            p++;
+        }
+        if (p < pEnd && (*p == '-' || *p == '+'))
+        {
+            bNeg = *p == '-';
+            p++;
+        }
+        return p < pEnd;
+    }
+    static bool IsBlank(const char* p, const char* pEnd)
+    {
+        for (; p < pEnd; p++)
+        {
+            if (*p != ' ' && *p != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// DBFļд
+// TStorageΪ洢(CDbfFile/CDbfStdioFile/CDbfPreadFile/CDbfMmapFile/CDbfMemFile)
+// TParseΪֶν(CDbfDefaultParse/CDbfFastParse)ȷԱ麯
+// Ҫʱ̬ʱͨCDbfAdapterʹCIDbfӿ
+template<class TStorage = CDbfFile, class TParse = CDbfDefaultParse>
+class BasicDbf : public CDbfBase
+{
+public:
+    // 캯
+    BasicDbf()
+        :m_cBlank(' ')
+    {
+        // עϢ
+        m_nRemarkLen = 0;
+        // ǰ
+        m_nCurRec = 0;
+        // ļл
+        m_pWriteBuf = NULL;
+        m_pReadBuf = NULL;
+        m_pBufPool = &m_oBufPool;
+        m_pStats = NULL;
+        m_bReadOnly = true;
+        // ȡǰ
+        int nY = 0, nM = 0, nD = 0;
+        GetCurDate(nY, nM, nD);
+        m_cYear = nY;
+        m_cMonth = nM;
+        m_cDay = nD;
+    }
+    ~BasicDbf()
+    {
+        Close();
+    }
+
+    // жļǷ
+    inline bool IsOpen() { return m_oFile.IsOpen(); }
+    // ǷΪڴģʽ
+    inline bool IsInMemory() { return m_oFile.IsInMemory(); }
+
+    // öдʹõڴأɹͬһڴأΪʱʹöԴڴ
+    // ڴص賤ڱ
+    void SetBufPool(CDbfBufPool* pPool)
+    {
+        // Ļ黹ԭڴ
+        delete m_pWriteBuf;
+        m_pWriteBuf = NULL;
+        delete m_pReadBuf;
+        m_pReadBuf = NULL;
+        m_pBufPool = pPool ? pPool : &m_oBufPool;
+    }
+    inline CDbfBufPool* GetBufPool() { return m_pBufPool; }
+
+    // ͳƶΪʱرͳƣͳƶ賤ڱ󣬲߳еĶ
+    inline void SetStats(TDbfStats* pStats) { m_pStats = pStats; }
+    inline TDbfStats* GetStats() { return m_pStats; }
+
+    // ļ
     int Open(const std::string& strFile, bool bReadOnly = true)
     {
         // ǷѴ
@@ -430,40 +1671,165 @@ public:
         {
             return DBF_SUCC;
         }
-        m_bReadOnly = bReadOnly;
-        if (ws_fopen(&m_pFile, strFile.c_str(), bReadOnly ? "rb" : "rb+"))
+        if (m_oFile.Open(strFile, bReadOnly))
+        {
+            return DBF_FILE_ERROR;
+        }
+        return Load(strFile, bReadOnly);
+    }
+
+    // ڴģʽļļһڴ棬֮Ķд׷Ӿڴɣ
+    // ͨSave/Flushһ˳дļCDbfFile洢֧
+    int OpenInMemory(const std::string& strFile, bool bReadOnly = true)
+    {
+        if (IsOpen())
+        {
+            return DBF_SUCC;
+        }
+        if (m_oFile.Open(strFile, bReadOnly, true))
+        {
+            return DBF_FILE_ERROR;
+        }
+        return Load(strFile, bReadOnly);
+    }
+    // ڴģʽѶڴļӳ񣬽ӹvecImageеݣstrFileΪSaveʱĬ·
+    int OpenInMemory(const std::string& strFile, std::vector<char>& vecImage, bool bReadOnly = true)
+    {
+        if (IsOpen())
+        {
+            return DBF_SUCC;
+        }
+        if (m_oFile.Open(vecImage, bReadOnly))
+        {
+            return DBF_FILE_ERROR;
+        }
+        return Load(strFile, bReadOnly);
+    }
+
+    // ȡֶϢ
+    std::vector<TDbfField> GetField() { return m_vecField; }
+
+    // ֶϢpFieldΪļͷֶ֮(n*32ֽ+0x0D)nFieldLenΪֶ
+    static int ParseField(const char* pField, size_t nFieldLen, std::vector<TDbfField>& vecField, std::map<std::string, size_t>& mapField)
+    {
+        if (nFieldLen % 32 != 1)
+        {
+            return DBF_FILE_ERROR;
+        }
+        TDbfField oField;
+        const char* pCur = pField;
+        const char* pEnd = pField + nFieldLen - 1;
+        // ֶƫֵ1ʼλΪ־λ
+        int nOffset = 1;
+        vecField.clear();
+        mapField.clear();
+        while (pCur < pEnd)
+        {
+            // ֶϢ
+            memcpy(&oField, pCur, sizeof(oField));
+            pCur += sizeof(oField);
+
+            // ֶƫֵ
+            oField.nPosition = nOffset;
+            nOffset += oField.cLength;
+
+            // ֶ
+            vecField.push_back(oField);
+            mapField.insert(std::pair<std::string, size_t>(std::string(oField.szName, strnlen(oField.szName, sizeof(oField.szName))), vecField.size() - 1));
+        }
+        // УһλǷΪ0x0D
+        if (*pCur != 0x0D)
+        {
+            return DBF_FILE_ERROR;
+        }
+        return DBF_SUCC;
+    }
+    // ֶбаƲֶΣţʱvecField.size()
+    static size_t FindField(const std::vector<TDbfField>& vecField, const std::string& strName)
+    {
+        for (size_t i = 0; i < vecField.size(); i++)
+        {
+            if (strName == std::string(vecField[i].szName, strnlen(vecField[i].szName, sizeof(vecField[i].szName))))
+            {
+                return i;
+            }
+        }
+        return vecField.size();
+    }
+
+    // ȡע
+    static size_t GetRemarkSize(char cVer)
+    {
+        size_t nRemark = 0;
+        int nVer = cVer;
+        switch (nVer)
+        {
+        case FV_MD3P:
+        case FV_MD4:
+        case FV_MD4TABLE:
+        case FV_MFP2:
+        case FV_VFP:
+            nRemark = 263;
+            break;
+        default:
+            break;
+        }
+        return nRemark;
+    }
+
+    // ȡļӳ(ļͷ+ֶ+ע+¼+־)δύд
+    int ReadImage(std::vector<char>& vecImage)
+    {
+        if (!IsOpen())
+        {
+            return DBF_FILE_ERROR;
+        }
+        // ӳڵַռ
+        if (FileSize() > vecImage.max_size())
+        {
+            return DBF_CACHE_ERROR;
+        }
+        vecImage.resize((size_t)FileSize());
+        // stdio
+        m_oFile.DropCache();
+        size_t nRead = ReadAt(0, &vecImage[0], vecImage.size());
+        if (nRead + 1 < vecImage.size())
+        {
+            return DBF_FILE_ERROR;
+        }
+        // ļûн־
+        vecImage.back() = 0x1A;
+        return DBF_SUCC;
+    }
+
+    // ¶ȡļͷ׷Ӽ¼¼¼½ֶ
+    // ļͷȻ¼ȱ仯ʱDBF_FILE_ERRORҪ´ļ
+    int RefreshHeader()
+    {
+        if (!IsOpen())
         {
             return DBF_FILE_ERROR;
         }
-        // ȡļͷϢ
-        if (ReadHeader())
+        // stdio棬ܶеľļͷ
+        m_oFile.DropCache();
+        TDbfHeader oHeader;
+        if (ReadAt(0, &oHeader, sizeof(oHeader)) != sizeof(oHeader))
         {
             return DBF_FILE_ERROR;
         }
-        // ȡֶϢ
-        if (ReadField())
+        if (oHeader.nHeaderLen != m_oHeader.nHeaderLen || oHeader.nRecLen != m_oHeader.nRecLen)
         {
             return DBF_FILE_ERROR;
         }
-
-        // ʼ
-        m_nCurRec = 0;
-        m_strFilePath = strFile;
+        m_oHeader = oHeader;
         return DBF_SUCC;
     }
 
-    // ȡֶϢ
-    std::vector<TDbfField> GetField() { return m_vecField; }
-
     // رDBFļ
     void Close()
     {
         // رļ
-        if (m_pFile)
-        {
-            fclose(m_pFile);
-            m_pFile = NULL;
-        }
+        m_oFile.Close();
 
         // ڴ
         delete m_pWriteBuf;
@@ -474,7 +1840,54 @@ public:
     }
 
     // ļ,ֵֶơȼǱ
-    virtual int Create(const std::string& strFile, const std::vector<TDbfField>& vecField)
+    int Create(const std::string& strFile, const std::vector<TDbfField>& vecField)
+    {
+        Close();
+        if (m_oFile.Create(strFile))
+        {
+            return DBF_ERROR;
+        }
+        return InitFile(strFile, vecField);
+    }
+    // ڴģʽļͨSave/FlushдstrFileCDbfFile洢֧
+    int CreateInMemory(const std::string& strFile, const std::vector<TDbfField>& vecField)
+    {
+        Close();
+        if (m_oFile.Create(strFile, true))
+        {
+            return DBF_ERROR;
+        }
+        return InitFile(strFile, vecField);
+    }
+
+    // ڴģʽ½ļһ˳дstrFile(Ϊʱд򿪻򴴽ʱ·)ֻʱDBF_PARA_ERROR
+    // ͨļģʽˢд
+    int Save(const std::string& strFile = "")
+    {
+        if (!IsOpen())
+        {
+            return DBF_FILE_ERROR;
+        }
+        if (!IsInMemory())
+        {
+            return m_oFile.Flush();
+        }
+        // ȫļ־
+        if (!m_bReadOnly && WriteEndFlag())
+        {
+            return DBF_ERROR;
+        }
+        return m_oFile.Save(strFile.empty() ? m_strFilePath : strFile);
+    }
+    // ˢµļڴģʽдش򿪻򴴽ʱ·
+    int Flush()
+    {
+        return Save();
+    }
+
+private:
+    // ½ĿļдļͷֶϢ
+    int InitFile(const std::string& strFile, const std::vector<TDbfField>& vecField)
     {
         // ͷϢ
         TDbfHeader oHeader;
@@ -496,11 +1909,10 @@ public:
             mapField.insert(std::pair<std::string, size_t>(vecNewField[i].szName, i));
         }
 
-        // ½ļ
-        Close();
-        FILE* pFile = NULL;
-        if (NewFile(strFile, oHeader, vecNewField, &pFile))
+        // дļͷ
+        if (NewFile(oHeader, vecNewField))
         {
+            m_oFile.Close();
             return DBF_ERROR;
         }
 
@@ -509,13 +1921,30 @@ public:
         m_oHeader = oHeader;
         m_vecField = vecNewField;
         m_mapField = mapField;
-        m_pFile = pFile;
         m_nCurRec = 0;
         m_strFilePath = strFile;
         m_nRemarkLen = GetRemarkSize(m_oHeader.cVer);
         return DBF_SUCC;
     }
 
+    // 򿪺ȡļͷֶϢ
+    int Load(const std::string& strFile, bool bReadOnly)
+    {
+        m_bReadOnly = bReadOnly;
+        // ȡļͷϢֶϢ
+        if (ReadHeader() || ReadField())
+        {
+            m_oFile.Close();
+            return DBF_FILE_ERROR;
+        }
+
+        // ʼ
+        m_nCurRec = 0;
+        m_strFilePath = strFile;
+        return DBF_SUCC;
+    }
+
+public:
 
     // 
     int Zap()
@@ -532,10 +1961,9 @@ public:
         m_oHeader.nRecNum = 0;
 
         // ½ļ
-        fclose(m_pFile);
-        m_pFile = NULL;
-        if (!NewFile(m_strFilePath, m_oHeader, m_vecField, &m_pFile))
+        if (m_oFile.Truncate(0) || NewFile(m_oHeader, m_vecField))
         {
+            m_oFile.Close();
             return DBF_ERROR;
         }
         // Ĭֵ
@@ -545,7 +1973,7 @@ public:
 
     // ֱӲļຯ¼Ϊ0
     // ַʽȡֶ
-    virtual std::string ReadString(size_t nRecNo, const std::string& strName)
+    std::string ReadString(size_t nRecNo, const std::string& strName)
     {
         std::string strValue;
         if (!IsOpen() || nRecNo >= m_oHeader.nRecNum)
@@ -561,7 +1989,7 @@ public:
         return strValue;
     }
     // ַʽдֶ
-    virtual int WriteString(size_t nRecNo, const std::string& strName, const std::string& strValue)
+    int WriteString(size_t nRecNo, const std::string& strName, const std::string& strValue)
     {
         if (!IsOpen() || nRecNo >= m_oHeader.nRecNum || m_bReadOnly)
         {
@@ -575,7 +2003,7 @@ public:
         return WriteField(nRecNo, nSeq, strValue);
     }
     // ַʽȡֶ
-    virtual int ReadField(size_t nRecNo, size_t nCol, std::string& strValue)
+    int ReadField(size_t nRecNo, size_t nCol, std::string& strValue)
     {
         if (!IsOpen() || nRecNo >= m_oHeader.nRecNum || nCol>=m_vecField.size())
         {
@@ -584,31 +2012,36 @@ public:
         int nRet = DBF_ERROR;
         // Ŀ¼еλ
         TDbfField& oField = m_vecField[nCol];
-        size_t nCurOffset = RecordOffset() + nRecNo * m_oHeader.nRecLen + oField.nPosition;
+        unsigned long long nCurOffset = RecordOffset(nRecNo) + oField.nPosition;
         // лӦļ¼
-        char* pField = new char[oField.nPosition];
-        fseek(m_pFile, nCurOffset, SEEK_SET);
-        size_t nRead = fread(pField, 1, oField.cLength, m_pFile);
+        char szField[256];
+        size_t nRead = ReadAt(nCurOffset, szField, oField.cLength);
         if (nRead == oField.cLength)
         {
-            strValue = std::string(pField, oField.cLength);
+            strValue = std::string(szField, oField.cLength);
             nRet = DBF_SUCC;
         }
-        delete[] pField;
         return nRet;
     }
     // ļ׷Ӽ¼nAppendNumָ
-    virtual int Append(size_t nAppendNum)
+    int Append(size_t nAppendNum)
     {
         if (!IsOpen() || m_bReadOnly)
         {
             return DBF_PARA_ERROR;
         }
-        // ڴ
-        CRecordBuf oBuf(nAppendNum, m_oHeader.nRecLen);
-        size_t nCurOffset = FileSize() - 1;
-        fseek(m_pFile, nCurOffset, SEEK_SET);
-        size_t nRead = fwrite(oBuf.Data(), 1, oBuf.DataSize(), m_pFile);
+        if ((unsigned long long)m_oHeader.nRecNum + nAppendNum > 0xFFFFFFFFULL)
+        {
+            return DBF_OVERFLOW_ERROR;
+        }
+        // ڴ棬¼Ϊո
+        CRecordBuf oBuf(nAppendNum, m_oHeader.nRecLen, m_pBufPool);
+        if (nAppendNum && !oBuf.WriteGo(nAppendNum - 1))
+        {
+            return DBF_CACHE_ERROR;
+        }
+        unsigned long long nCurOffset = FileSize() - 1;
+        size_t nRead = WriteAt(nCurOffset, oBuf.Data(), oBuf.DataSize());
         if (nRead != oBuf.DataSize())
         {
             return DBF_ERROR;
@@ -630,7 +2063,7 @@ public:
     }
 
     // дֶַ 
-    virtual int WriteField(size_t nRecNo, size_t nCol, const std::string& strValue)
+    int WriteField(size_t nRecNo, size_t nCol, const std::string& strValue)
     {
         if (!IsOpen() || nRecNo >= m_oHeader.nRecNum || nCol >= m_vecField.size() || m_bReadOnly)
         {
@@ -638,14 +2071,12 @@ public:
         }
         // Ŀ¼еλ
         TDbfField& oField = m_vecField[nCol];
-        size_t nCurOffset = RecordOffset() + nRecNo * m_oHeader.nRecLen  + oField.nPosition;
+        unsigned long long nCurOffset = RecordOffset(nRecNo) + oField.nPosition;
         char* pField = new char[oField.cLength];
         memset(pField, m_cBlank, oField.cLength);
         memcpy(pField, strValue.c_str(), MMin(oField.cLength, strValue.size()));
-        // лӦļ¼
-        fseek(m_pFile, nCurOffset, SEEK_SET);
         // дֶ
-        size_t nWrite = fwrite(pField, 1, oField.cLength, m_pFile);
+        size_t nWrite = WriteAt(nCurOffset, pField, oField.cLength);
         delete[] pField;
         if (nWrite != oField.cLength)
         {
@@ -654,37 +2085,109 @@ public:
         return DBF_SUCC;
     }
 
+    // nRecNoʼдnNumԭʼ¼ļ¼Ĳ׷ӵļβ
+    int WriteRecord(size_t nRecNo, const char* pData, size_t nNum)
+    {
+        if (!IsOpen() || m_bReadOnly || !pData || nRecNo > m_oHeader.nRecNum)
+        {
+            return DBF_PARA_ERROR;
+        }
+        if ((unsigned long long)nRecNo + nNum > 0xFFFFFFFFULL)
+        {
+            return DBF_OVERFLOW_ERROR;
+        }
+        size_t nSize = nNum * m_oHeader.nRecLen;
+        if (WriteAt(RecordOffset(nRecNo), pData, nSize) != nSize)
+        {
+            return DBF_ERROR;
+        }
+        // ׷¼¼ͷд־
+        if (nRecNo + nNum > m_oHeader.nRecNum)
+        {
+            m_oHeader.nRecNum = (unsigned int)(nRecNo + nNum);
+            m_oHeader.cYy = m_cYear;
+            m_oHeader.cMm = m_cMonth;
+            m_oHeader.cDd = m_cDay;
+            if (WriteHeader() || WriteEndFlag())
+            {
+                return DBF_ERROR;
+            }
+        }
+        return DBF_SUCC;
+    }
+
+    // ضļnRecNum¼
+    int Truncate(size_t nRecNum)
+    {
+        if (!IsOpen() || m_bReadOnly || nRecNum > m_oHeader.nRecNum)
+        {
+            return DBF_PARA_ERROR;
+        }
+        m_oHeader.nRecNum = (unsigned int)nRecNum;
+        m_oHeader.cYy = m_cYear;
+        m_oHeader.cMm = m_cMonth;
+        m_oHeader.cDd = m_cDay;
+        if (WriteHeader() || WriteEndFlag())
+        {
+            return DBF_ERROR;
+        }
+        if (m_oFile.Truncate(FileSize()))
+        {
+            return DBF_FILE_ERROR;
+        }
+        if (m_nCurRec > nRecNum)
+        {
+            m_nCurRec = nRecNum;
+        }
+        return DBF_SUCC;
+    }
+
     // ļ¼
     inline size_t GetRecNum() { return m_oHeader.nRecNum; }
     // ֶ
     inline size_t GetFieldNum() { return m_vecField.size(); }
+    // ¼(ɾ־λ)
+    inline size_t GetRecLen() { return m_oHeader.nRecLen; }
+    // ļͷϢ
+    inline TDbfHeader GetHeader() { return m_oHeader; }
+
+    // ȡеԭʼ¼д0ʼм¼ڴ
+    const char* ReadData(size_t nRec = 0)
+    {
+        if (!m_pReadBuf)
+        {
+            return NULL;
+        }
+        return m_pReadBuf->At(nRec);
+    }
 
     // ȡ¼е
-    int Read(int nRecNo, int nRecNum)
+    int Read(size_t nRecNo, size_t nRecNum)
     {
         if (!IsOpen())
         {
             return DBF_FILE_ERROR;
         }
         // ת¼
-        if (!IsValidRecNo(nRecNo + nRecNum) || Go(nRecNo))
+        if (nRecNo + nRecNum < nRecNo || !IsValidRecNo(nRecNo + nRecNum) || Go(nRecNo))
         {
             return DBF_PARA_ERROR;
         }
         size_t nSize = nRecNum * m_oHeader.nRecLen;
-        // ǰ治ٶ
-        if (m_pReadBuf)
+        if (m_pStats)
         {
-            if (nSize > m_pReadBuf->BufSize())
-            {
-                delete m_pReadBuf;
-                m_pReadBuf = NULL;
-            }
+            m_pStats->nReadBatch++;
+            m_pStats->nRealloc += !m_pReadBuf || nRecNum > m_pReadBuf->RecCapacity();
         }
-        // ڴ
+        // ڴ棬ǰ治ʱڴ
         if (!m_pReadBuf)
         {
-            m_pReadBuf = new CRecordBuf(nRecNum, m_oHeader.nRecLen);
+            m_pReadBuf = new CRecordBuf(nRecNum, m_oHeader.nRecLen, m_pBufPool);
+        }
+        m_pReadBuf->Reserve(nRecNum);
+        if (nSize > m_pReadBuf->BufSize())
+        {
+            return DBF_CACHE_ERROR;
         }
         size_t nRead = _read(m_pReadBuf->Data(), 1, nSize);
         if (nRead != nSize)
@@ -695,8 +2198,92 @@ public:
         return DBF_SUCC;
     }
 
+    // ȡ¼е÷pData(nRecNum*GetRecLen()ֽ)棬ֻȡдļļ¼
+    // ֻʹʱӶٿһ
+    int ReadRecord(size_t nRecNo, char* pData, size_t nRecNum)
+    {
+        if (!IsOpen())
+        {
+            return DBF_FILE_ERROR;
+        }
+        if (!pData || nRecNo + nRecNum < nRecNo || nRecNo + nRecNum > m_oHeader.nRecNum)
+        {
+            return DBF_PARA_ERROR;
+        }
+        if (m_pStats)
+        {
+            m_pStats->nReadBatch++;
+        }
+        size_t nSize = nRecNum * m_oHeader.nRecLen;
+        if (ReadAt(RecordOffset(nRecNo), pData, nSize) != nSize)
+        {
+            return DBF_ERROR;
+        }
+        return DBF_SUCC;
+    }
+
+    // һԶȡ¼е棬ڶȡдļ
+    // ȡǰȽļС޸ʱ估ļͷ¼ɾ־λ
+    // һʱֻԱ¼nRetryԲһ·DBF_CACHE_ERROR
+    // bVerifyΪtrueʱٶһα¼Ƚϣȡӱɷ޸ʱδ仯д
+    int ReadSnapshot(size_t nRecNo, size_t nRecNum, int nRetry = 8, bool bVerify = true)
+    {
+        if (!IsOpen())
+        {
+            return DBF_FILE_ERROR;
+        }
+        for (int i = 0; i <= nRetry; i++)
+        {
+            unsigned long long nSize1 = 0, nSize2 = 0;
+            long long nTime1 = 0, nTime2 = 0;
+            // stdio沢¶ȡļͷ
+            if (RefreshHeader() || m_oFile.Stat(nSize1, nTime1))
+            {
+                return DBF_FILE_ERROR;
+            }
+            TDbfHeader oHeader = m_oHeader;
+            if (nRecNo > m_oHeader.nRecNum || nRecNum > m_oHeader.nRecNum - nRecNo)
+            {
+                return DBF_PARA_ERROR;
+            }
+            // շΧûҪȡͱȽϵļ¼
+            if (nRecNum == 0)
+            {
+                return DBF_SUCC;
+            }
+            // ļͷ¼ļСд뷽׷ӻض
+            bool bValid = nSize1 >= RecordOffset(m_oHeader.nRecNum);
+            if (bValid)
+            {
+                // д뷽ضļʱܶȡԱ
+                if (Read(nRecNo, nRecNum))
+                {
+                    continue;
+                }
+                bValid = IsValidRecData(m_pReadBuf->Data(), nRecNum);
+            }
+            // ޸ʱ侫(ͨΪ뼶ʱӽ)ٶһαȽԷͬһڵд
+            if (bValid && bVerify)
+            {
+                // ȶstdio棬СʱֱӴͬһأȽϱȻһ
+                size_t nSize = (size_t)nRecNum * m_oHeader.nRecLen;
+                m_vecVerify.resize(nSize);
+                m_oFile.DropCache();
+                bValid = ReadAt(RecordOffset(nRecNo), &m_vecVerify[0], nSize) == nSize
+                    && memcmp(&m_vecVerify[0], m_pReadBuf->Data(), nSize) == 0;
+            }
+            // ȡڼļδ仯
+            if (bValid && RefreshHeader() == DBF_SUCC && m_oFile.Stat(nSize2, nTime2) == 0
+                && nSize1 == nSize2 && nTime1 == nTime2 && memcmp(&oHeader, &m_oHeader, sizeof(oHeader)) == 0)
+            {
+                return DBF_SUCC;
+            }
+        }
+        return DBF_CACHE_ERROR;
+    }
+
     // öָ, 0ʼ, ¼
-    int ReadGo(int nRec)
+    int ReadGo(size_t nRec)
     {
         if (!IsOpen())
         {
@@ -714,25 +2301,25 @@ public:
     }
 
     // ȡֶ,ֶ
-    virtual std::string ReadString(const std::string& strName)
+    std::string ReadString(const std::string& strName)
     {
         std::string strValue;
         ReadString(strName, strValue);
         return strValue;
     }
-    virtual double ReadDouble(const std::string& strName)
+    double ReadDouble(const std::string& strName)
     {
         double fValue = 0.0f;
         ReadDouble(strName, fValue);
         return fValue;
     }
-    virtual int ReadInt(const std::string& strName)
+    int ReadInt(const std::string& strName)
     {
         int nValue = 0;
         ReadInt(strName, nValue);
         return nValue;
     }
-    virtual long ReadLong(const std::string& strName)
+    long ReadLong(const std::string& strName)
     {
         long nValue = 0;
         ReadLong(strName, nValue);
@@ -810,12 +2397,20 @@ public:
         {
             return DBF_FILE_ERROR;
         }
-        std::string strField;
-        if (ReadField(nCol, strField))
+        const char* pField = CurField(nCol);
+        if (!pField)
         {
             return DBF_ERROR;
         }
-        fValue = atof(strField.c_str());
+        if (!m_pStats)
+        {
+            fValue = TParse::ToDouble(pField, m_vecField[nCol].cLength);
+            return DBF_SUCC;
+        }
+        long long nStart = m_pStats->Start();
+        fValue = TParse::ToDouble(pField, m_vecField[nCol].cLength);
+        m_pStats->nParseNum++;
+        m_pStats->nDecodeNs += m_pStats->Since(nStart);
         return DBF_SUCC;
     }
     int ReadInt(size_t nCol, int& nValue)
@@ -824,12 +2419,20 @@ public:
         {
             return DBF_FILE_ERROR;
         }
-        std::string strField;
-        if (ReadField(nCol, strField))
+        const char* pField = CurField(nCol);
+        if (!pField)
         {
             return DBF_ERROR;
         }
-        nValue = atoi(strField.c_str());
+        if (!m_pStats)
+        {
+            nValue = TParse::ToInt(pField, m_vecField[nCol].cLength);
+            return DBF_SUCC;
+        }
+        long long nStart = m_pStats->Start();
+        nValue = TParse::ToInt(pField, m_vecField[nCol].cLength);
+        m_pStats->nParseNum++;
+        m_pStats->nDecodeNs += m_pStats->Since(nStart);
         return DBF_SUCC;
     }
     int ReadLong(size_t nCol, long& nValue)
@@ -838,12 +2441,20 @@ public:
         {
             return DBF_FILE_ERROR;
         }
-        std::string strField;
-        if (ReadField(nCol, strField))
+        const char* pField = CurField(nCol);
+        if (!pField)
         {
             return DBF_ERROR;
         }
-        nValue = atol(strField.c_str());
+        if (!m_pStats)
+        {
+            nValue = TParse::ToLong(pField, m_vecField[nCol].cLength);
+            return DBF_SUCC;
+        }
+        long long nStart = m_pStats->Start();
+        nValue = TParse::ToLong(pField, m_vecField[nCol].cLength);
+        m_pStats->nParseNum++;
+        m_pStats->nDecodeNs += m_pStats->Since(nStart);
         return DBF_SUCC;
     }
 
@@ -859,20 +2470,24 @@ public:
         {
             return DBF_PARA_ERROR;
         }
+        if ((unsigned long long)m_oHeader.nRecNum + nRecNum > 0xFFFFFFFFULL)
+        {
+            return DBF_OVERFLOW_ERROR;
+        }
         size_t nSize = nRecNum * m_oHeader.nRecLen;
-        // д治ٻ
-        if (m_pWriteBuf)
+        if (m_pStats)
         {
-            if (nSize > m_pWriteBuf->BufSize())
-            {
-                delete m_pWriteBuf;
-                m_pWriteBuf = NULL;
-            }
+            m_pStats->nRealloc += !m_pWriteBuf || nRecNum > m_pWriteBuf->RecCapacity();
         }
-        // ڴ
+        // дڴ棬ǰд治ʱڴ
         if (!m_pWriteBuf)
         {
-            m_pWriteBuf = new CRecordBuf(nRecNum, m_oHeader.nRecLen);
+            m_pWriteBuf = new CRecordBuf(nRecNum, m_oHeader.nRecLen, m_pBufPool);
+        }
+        m_pWriteBuf->Reserve(nRecNum);
+        if (nSize > m_pWriteBuf->BufSize())
+        {
+            return DBF_CACHE_ERROR;
         }
         m_pWriteBuf->WriteReset();
         return DBF_SUCC;
@@ -906,6 +2521,14 @@ public:
         {
             return DBF_ERROR;
         }
+        if ((unsigned long long)m_oHeader.nRecNum + m_pWriteBuf->Size() > 0xFFFFFFFFULL)
+        {
+            return DBF_OVERFLOW_ERROR;
+        }
+        if (m_pStats)
+        {
+            m_pStats->nWriteBatch++;
+        }
         // дݼ¼
         size_t nAppendSize = m_pWriteBuf->Size() * m_pWriteBuf->RecLen();
         size_t nWrite = _write(m_pWriteBuf->Data(), 1, nAppendSize);
@@ -923,8 +2546,14 @@ public:
         {
             return DBF_ERROR;
         }
-        // ǰи
+        // ˢµϵͳʹļ̿ɼ(д¼дͷ)
+        if (m_oFile.Flush())
+        {
+            return DBF_FILE_ERROR;
+        }
+        // ǰи£ύݴд
         m_nCurRec = m_oHeader.nRecNum;
+        m_pWriteBuf->WriteReset();
         return DBF_SUCC;
     }
     // ύдݵļ
@@ -943,7 +2572,7 @@ public:
     }
 
     // дָ, 0ʼ, ¼
-    int WriteGo(int nRec)
+    int WriteGo(size_t nRec)
     {
         if (!IsOpen())
         {
@@ -960,6 +2589,89 @@ public:
         return DBF_SUCC;
     }
 
+    // ׷ӵд棬pValueֶ˳ţnNumСֶʱֶΪ
+    // ҪPrepareAppendWriteGo治ʱԶͨWriteCommitдļ
+    int AppendRow(const TDbfValue* pValue, size_t nNum)
+    {
+        return AppendRows(pValue, nNum, 1);
+    }
+    // ׷nRowУpValueţÿnColֵֶ
+    int AppendRows(const TDbfValue* pValue, size_t nCol, size_t nRow)
+    {
+        if (!IsOpen())
+        {
+            return DBF_FILE_ERROR;
+        }
+        if (m_bReadOnly || nCol > m_vecField.size() || (!pValue && nCol && nRow))
+        {
+            return DBF_PARA_ERROR;
+        }
+        if (nRow == 0)
+        {
+            return DBF_SUCC;
+        }
+        if (IsRecNumOverflow(nRow))
+        {
+            return DBF_OVERFLOW_ERROR;
+        }
+        // д棬
+        if (!m_pWriteBuf)
+        {
+            m_pWriteBuf = new CRecordBuf(nRow, m_oHeader.nRecLen, m_pBufPool);
+            if (m_pStats)
+            {
+                m_pStats->nRealloc++;
+            }
+        }
+        size_t nNeed = m_pWriteBuf->RecNum() + nRow;
+        if (nNeed > m_pWriteBuf->RecCapacity())
+        {
+            if (m_pStats)
+            {
+                m_pStats->nRealloc++;
+            }
+            m_pWriteBuf->Resize(MMax(nNeed, m_pWriteBuf->RecCapacity() * 2));
+        }
+        char* pRec = m_pWriteBuf->AppendRec(nRow);
+        if (!pRec)
+        {
+            return DBF_CACHE_ERROR;
+        }
+
+        // иʽÿֻֽдһ
+        const size_t nRecLen = m_oHeader.nRecLen;
+        const size_t nField = m_vecField.size();
+        for (size_t i = 0; i < nRow; i++, pRec += nRecLen, pValue += nCol)
+        {
+            // ɾ־
+            pRec[0] = ' ';
+            for (size_t j = 0; j < nField; j++)
+            {
+                const TDbfField& oField = m_vecField[j];
+                char* pField = pRec + oField.nPosition;
+                size_t nSize = 0;
+                if (j < nCol)
+                {
+                    nSize = MMin((size_t)oField.cLength, pValue[j].nLen);
+                    if (nSize)
+                    {
+                        memcpy(pField, pValue[j].pData, nSize);
+                    }
+                }
+                memset(pField + nSize, m_cBlank, oField.cLength - nSize);
+            }
+        }
+        return DBF_SUCC;
+    }
+    int AppendRows(const std::vector<TDbfValue>& vecValue, size_t nCol)
+    {
+        if (nCol == 0 || vecValue.size() % nCol)
+        {
+            return DBF_PARA_ERROR;
+        }
+        return AppendRows(vecValue.empty() ? NULL : &vecValue[0], nCol, vecValue.size() / nCol);
+    }
+
     // ֶдֶ
     int WriteString(const std::string& strName, const std::string& strValue)
     {
@@ -1033,9 +2745,15 @@ public:
             return DBF_PARA_ERROR;
         }
         TDbfField& oField = m_vecField[nCol];
-        char szBuf[64] = { 0 };
-        sprintf_s(szBuf, "%%%d.%df", (int)oField.cLength, (int)oField.cPrecisionLength);
-        return WriteField(nCol, szBuf);
+        char szBuf[512];
+        long long nStart = m_pStats ? m_pStats->Start() : 0;
+        size_t nLen = TParse::FormatDouble(szBuf, sizeof(szBuf), fValue, (int)oField.cLength, (int)oField.cPrecisionLength);
+        if (m_pStats)
+        {
+            m_pStats->nParseNum++;
+            m_pStats->nDecodeNs += m_pStats->Since(nStart);
+        }
+        return WriteField(nCol, szBuf, nLen);
     }
     int WriteInt(size_t nCol, int nValue)
     {
@@ -1047,9 +2765,15 @@ public:
         {
             return DBF_PARA_ERROR;
         }
-        char szBuf[64] = { 0 };
-        sprintf_s(szBuf, "%d", nValue);
-        return WriteField(nCol, szBuf);
+        char szBuf[64];
+        long long nStart = m_pStats ? m_pStats->Start() : 0;
+        size_t nLen = TParse::FormatLong(szBuf, sizeof(szBuf), nValue);
+        if (m_pStats)
+        {
+            m_pStats->nParseNum++;
+            m_pStats->nDecodeNs += m_pStats->Since(nStart);
+        }
+        return WriteField(nCol, szBuf, nLen);
     }
     int WriteLong(size_t nCol, long nValue)
     {
@@ -1061,14 +2785,20 @@ public:
         {
             return DBF_PARA_ERROR;
         }
-        char szBuf[64] = { 0 };
-        sprintf_s(szBuf, "%ld", nValue);
-        return WriteField(nCol, szBuf);
+        char szBuf[64];
+        long long nStart = m_pStats ? m_pStats->Start() : 0;
+        size_t nLen = TParse::FormatLong(szBuf, sizeof(szBuf), nValue);
+        if (m_pStats)
+        {
+            m_pStats->nParseNum++;
+            m_pStats->nDecodeNs += m_pStats->Since(nStart);
+        }
+        return WriteField(nCol, szBuf, nLen);
     }
 
 protected:
     // תָУ0ʼ
-    int Go(int nRec)
+    int Go(size_t nRec)
     {
         int nRet = DBF_SUCC;
         if (!IsOpen())
@@ -1113,6 +2843,15 @@ protected:
         strValue = std::string(pField, m_vecField[nField].cLength);
         return nRet;
     }
+    // 浱ǰеֶݣ
+    inline const char* CurField(size_t nField)
+    {
+        if (nField >= m_vecField.size() || !m_pReadBuf || m_pReadBuf->IsEmpty())
+        {
+            return NULL;
+        }
+        return m_pReadBuf->GetCurRow() + m_vecField[nField].nPosition;
+    }
 
     // дֶϢ
     int WriteField(const std::string& strName, const std::string& strValue)
@@ -1127,31 +2866,41 @@ protected:
     }
     int WriteField(size_t nField, const std::string& strValue)
     {
-        int nRet = DBF_SUCC;
+        return WriteField(nField, strValue.c_str(), strValue.size());
+    }
+    int WriteField(size_t nField, const char* pValue, size_t nLen)
+    {
         // ֶλ
         if (nField >= m_vecField.size())
         {
             return DBF_PARA_ERROR;
         }
+        if (!m_pWriteBuf)
+        {
+            return DBF_ERROR;
+        }
         // ȡֶϢ
         char* pField = m_pWriteBuf->GetCurRow();
         pField += m_vecField[nField].nPosition;
         size_t nMaxFieldSize = m_vecField[nField].cLength;
-        // ֶΪ
-        memset(pField, m_cBlank, nMaxFieldSize);
-        // ֶ
-        size_t nSize = MMin(nMaxFieldSize, strValue.size());
-        if (!memcpy(pField, strValue.c_str(), nSize))
-        {
-            nRet = DBF_ERROR;
-        }
-        return nRet;
+        // ֶݣʣಿÿ
+        size_t nSize = MMin(nMaxFieldSize, nLen);
+        memcpy(pField, pValue, nSize);
+        memset(pField + nSize, m_cBlank, nMaxFieldSize - nSize);
+        return DBF_SUCC;
+    }
+
+    // ׷nAdd¼(дδύļ¼)Ƿ񳬳ļͷ32λ¼
+    // ʱ谴βΪļREADME"ֶ"
+    bool IsRecNumOverflow(size_t nAdd)
+    {
+        unsigned long long nWrite = m_pWriteBuf ? m_pWriteBuf->RecNum() : 0;
+        return (unsigned long long)m_oHeader.nRecNum + nWrite + nAdd > 0xFFFFFFFFULL;
     }
 
     // жкǷϷдļ+
-    bool IsValidRecNo(unsigned int nNum)
+    bool IsValidRecNo(size_t nRec)
     {
-        size_t nRec = nNum;
         size_t nWrite = m_pWriteBuf ? m_pWriteBuf->RecNum() : 0;
         if (nRec > m_oHeader.nRecNum + nWrite)
         {
@@ -1160,12 +2909,31 @@ protected:
         return true;
     }
 
+    // ¼ɾ־λļ¼ʼֽͨ' ''*'
+    bool IsValidRecData(const char* pData, size_t nRecNum)
+    {
+        for (size_t i = 0; i < nRecNum; i++)
+        {
+            char cFlag = pData[i * m_oHeader.nRecLen];
+            if (cFlag != ' ' && cFlag != '*')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
     // ݼ¼ʼƫֵ
     size_t RecordOffset()
     {
         assert(IsOpen());
         return m_oHeader.nHeaderLen + m_nRemarkLen;
     }
+    // nRecNo¼ļƫƣ64λ㣬32λϵͳҲ
+    unsigned long long RecordOffset(size_t nRecNo)
+    {
+        return RecordOffset() + (unsigned long long)nRecNo * m_oHeader.nRecLen;
+    }
 
 private:
     // ȡļͷϢ
@@ -1174,8 +2942,7 @@ private:
         assert(IsOpen());
         // ȡͷϢ
         char szHeader[32] = { 0 };
-        fseek(m_pFile, SEEK_SET, 0);
-        size_t nRead = fread(szHeader, 1, sizeof(m_oHeader), m_pFile);
+        size_t nRead = ReadAt(0, szHeader, sizeof(m_oHeader));
         if (nRead != sizeof(m_oHeader))
         {
             return DBF_FILE_ERROR;
@@ -1186,26 +2953,6 @@ private:
         m_nRemarkLen = GetRemarkSize(m_oHeader.cVer);
         return DBF_SUCC;
     }
-    // ȡע
-    size_t GetRemarkSize(char cVer) const
-    {
-        size_t nRemark = 0;
-        int nVer = cVer;
-        switch (nVer)
-        {
-        case FV_MD3P:
-        case FV_MD4:
-        case FV_MD4TABLE:
-        case FV_MFP2:
-        case FV_VFP:
-            nRemark = 263;
-            break;
-        default:
-            break;
-        }
-        return nRemark;
-    }
-
     // ȡֶϢ
     int ReadField()
     {
@@ -1220,8 +2967,7 @@ private:
         // ȡֶϢ
         int nRet = DBF_SUCC;
         char* pField = new char[nFieldLen];
-        fseek(m_pFile, sizeof(m_oHeader), SEEK_SET);
-        size_t nRead = fread(pField, 1, nFieldLen, m_pFile);
+        size_t nRead = ReadAt(sizeof(m_oHeader), pField, nFieldLen);
         if (nRead != nFieldLen)
         {
             delete[] pField;
@@ -1230,32 +2976,7 @@ private:
         }
 
         // ֶ
-        TDbfField oField;
-        char* pCur = pField;
-        char* pEnd = pField + nFieldLen - sizeof(m_oHeader);
-        // ֶƫֵ1ʼλΪ־λ
-        int nOffset = 1;
-        m_vecField.clear();
-        m_mapField.clear();
-        while (pCur < pEnd)
-        {
-            // ֶϢ
-            memcpy(&oField, pCur, sizeof(oField));
-            pCur += sizeof(oField);
-
-            // ֶƫֵ
-            oField.nPosition = nOffset;
-            nOffset += oField.cLength;
-
-            // ֶ
-            m_vecField.push_back(oField);
-            m_mapField.insert(std::pair<std::string, size_t>(oField.szName, m_vecField.size() - 1));
-        }
-        // УһλǷΪ0x0D
-        if (*pCur != 0x0D)
-        {
-            nRet = DBF_FILE_ERROR;
-        }
+        nRet = ParseField(pField, nFieldLen, m_vecField, m_mapField);
         // ڴ
         delete[] pField;
         pField = NULL;
@@ -1275,7 +2996,7 @@ private:
 
 protected:
     // ȡ¼кļ뻺ݶȡҶȡʱ밴жȡ
-    virtual size_t _read(void* ptr, size_t size, size_t nmemb)
+    size_t _read(void* ptr, size_t size, size_t nmemb)
     {
         int nRet = DBF_SUCC;
         assert(IsOpen());
@@ -1283,11 +3004,10 @@ protected:
         if (m_nCurRec < m_oHeader.nRecNum)
         {
             // Ŀ¼еλ
-            size_t nCurOffset = m_nCurRec * m_oHeader.nRecLen + RecordOffset();
+            unsigned long long nCurOffset = RecordOffset(m_nCurRec);
 
             // лӦļ¼
-            fseek(m_pFile, nCurOffset, SEEK_SET);
-            return fread(ptr, size, nmemb, m_pFile);
+            return ReadAt(nCurOffset, ptr, size * nmemb) / size;
         }
         // ӻжȡݣд
         else if (m_pWriteBuf)
@@ -1309,7 +3029,7 @@ protected:
         return nRet;
     }
     // д¼кļ뻺ݲҲʱ밴
-    virtual size_t _write(void* ptr, size_t size, size_t nmemb)
+    size_t _write(void* ptr, size_t size, size_t nmemb)
     {
         int nRet = DBF_SUCC;
         assert(IsOpen());
@@ -1321,11 +3041,10 @@ protected:
         if (m_nCurRec <= m_oHeader.nRecNum)
         {
             // Ŀ¼еλ
-            size_t nCurOffset = m_nCurRec * m_oHeader.nRecLen + RecordOffset();
+            unsigned long long nCurOffset = RecordOffset(m_nCurRec);
 
             // лӦ¼Уд
-            fseek(m_pFile, nCurOffset, SEEK_SET);
-            return fwrite(ptr, size, nmemb, m_pFile);
+            return WriteAt(nCurOffset, ptr, size * nmemb) / size;
         }
         // д
         else if (m_pWriteBuf)
@@ -1347,6 +3066,37 @@ protected:
 
         return nRet;
     }
+    // ļƫƶдʵʶдֽ
+    inline size_t ReadAt(unsigned long long nOffset, void* ptr, size_t nSize)
+    {
+        assert(IsOpen());
+        if (!m_pStats)
+        {
+            return m_oFile.ReadAt(nOffset, ptr, nSize);
+        }
+        long long nStart = m_pStats->Start();
+        size_t nRead = m_oFile.ReadAt(nOffset, ptr, nSize);
+        m_pStats->nIoNs += m_pStats->Since(nStart);
+        m_pStats->nReadNum++;
+        m_pStats->nSeekNum += m_oFile.NeedSeek();
+        m_pStats->nReadBytes += nRead;
+        return nRead;
+    }
+    inline size_t WriteAt(unsigned long long nOffset, const void* ptr, size_t nSize)
+    {
+        assert(IsOpen());
+        if (!m_pStats)
+        {
+            return m_oFile.WriteAt(nOffset, ptr, nSize);
+        }
+        long long nStart = m_pStats->Start();
+        size_t nWrite = m_oFile.WriteAt(nOffset, ptr, nSize);
+        m_pStats->nIoNs += m_pStats->Since(nStart);
+        m_pStats->nWriteNum++;
+        m_pStats->nSeekNum += m_oFile.NeedSeek();
+        m_pStats->nWriteBytes += nWrite;
+        return nWrite;
+    }
     // дļ־
     size_t WriteEndFlag()
     {
@@ -1359,11 +3109,10 @@ protected:
         const char cEndFlag = 0X1A;
 
         // Ŀλ
-        size_t nOffset = FileSize() - 1;
+        unsigned long long nOffset = FileSize() - 1;
 
         // лӦ¼Уд
-        fseek(m_pFile, nOffset, SEEK_SET);
-        if (fwrite(&cEndFlag, 1, 1, m_pFile) != sizeof(cEndFlag))
+        if (WriteAt(nOffset, &cEndFlag, 1) != sizeof(cEndFlag))
         {
             return DBF_ERROR;
         }
@@ -1372,8 +3121,12 @@ protected:
     }
 
     // ֶλ
-    virtual size_t FindField(const std::string& strField)
+    size_t FindField(const std::string& strField)
     {
+        if (m_pStats)
+        {
+            m_pStats->nFindField++;
+        }
         std::map<std::string, size_t>::iterator e = m_mapField.find(strField);
         if (e != m_mapField.end())
         {
@@ -1385,8 +3138,7 @@ protected:
     // дͷݵļ
     int WriteHeader()
     {
-        fseek(m_pFile, 0, SEEK_SET);
-        if (fwrite(&m_oHeader, 1, sizeof(m_oHeader), m_pFile) != sizeof(m_oHeader))
+        if (WriteAt(0, &m_oHeader, sizeof(m_oHeader)) != sizeof(m_oHeader))
         {
             return DBF_ERROR;
         }
@@ -1394,68 +3146,32 @@ protected:
     }
 
     // ļС
-    size_t FileSize()
+    unsigned long long FileSize()
     {
         // ļͷ + ¼ + ļβ
-        return RecordOffset() + m_oHeader.nRecNum * m_oHeader.nRecLen + 1;
+        return RecordOffset(m_oHeader.nRecNum) + 1;
     }
 
-    // ½ļ
-    int NewFile(const std::string& strFile, const TDbfHeader& oHeader, const std::vector<TDbfField>& vecField, FILE** ppFile) const
+    // ½ĿļдļͷֶϢעϢ
+    int NewFile(const TDbfHeader& oHeader, const std::vector<TDbfField>& vecField)
     {
-        *ppFile = NULL;
-        int nRet = ws_fopen(ppFile, strFile.c_str(), "wb");
-        if (nRet)
+        size_t nFieldLen = vecField.size() * sizeof(TDbfField);
+        if (oHeader.nHeaderLen != sizeof(oHeader) + nFieldLen + 1)
         {
-            return DBF_FILE_ERROR;
-        }
-        FILE* pFile = *ppFile;
-
-        // дͷ
-        int nWrite = fwrite(&oHeader, 1, sizeof(oHeader), pFile);
-        if (nWrite != sizeof(oHeader))
-        {
-            fclose(pFile);
-            return DBF_FILE_ERROR;
+            return DBF_ERROR;
         }
-        // дֶϢ
-        for (size_t i = 0; i < vecField.size(); i++)
+        std::vector<char> vecHead(oHeader.nHeaderLen + GetRemarkSize(oHeader.cVer), 0);
+        // ļͷ + ֶϢ + ־ + עϢһд
+        memcpy(&vecHead[0], &oHeader, sizeof(oHeader));
+        if (nFieldLen)
         {
-            nWrite = fwrite(&vecField[i], 1, sizeof(vecField[i]), pFile);
-            if (nWrite != sizeof(vecField[i]))
-            {
-                fclose(pFile);
-                return DBF_FILE_ERROR;
-            }
+            memcpy(&vecHead[sizeof(oHeader)], &vecField[0], nFieldLen);
         }
-        // д־
-        const char cHeadEndFlag = 0X0D;
-        if (fwrite(&cHeadEndFlag, 1, sizeof(cHeadEndFlag), pFile) != sizeof(cHeadEndFlag))
+        vecHead[sizeof(oHeader) + nFieldLen] = 0X0D;
+        if (WriteAt(0, &vecHead[0], vecHead.size()) != vecHead.size())
         {
-            fclose(pFile);
             return DBF_FILE_ERROR;
         }
-        // עϢ
-        size_t nRemarkSize = GetRemarkSize(oHeader.cVer);
-        if (nRemarkSize)
-        {
-            char* pRemark = new char[nRemarkSize];
-            memset(pRemark, 0, nRemarkSize);
-            nWrite = fwrite(pRemark, 1, nRemarkSize, pFile);
-            delete[] pRemark;
-            if (nWrite != nRemarkSize)
-            {
-                fclose(pFile);
-                return DBF_FILE_ERROR;
-            }
-        }
-        // ļ
-        //const char cFileEndFlag = 0X1A;
-        //if (fwrite(&cFileEndFlag, 1, sizeof(cFileEndFlag), pFile) != sizeof(cFileEndFlag))
-        //{
-        //    fclose(pFile);
-        //    return DBF_FILE_ERROR;
-        //}
         return DBF_SUCC;
     }
 
@@ -1465,8 +3181,8 @@ private:
     unsigned char m_cMonth;
     unsigned char m_cDay;
 
-    // ļ
-    FILE* m_pFile;
+    // ļ洢
+    TStorage m_oFile;
     // ļ·
     std::string m_strFilePath;
     // Ƿֻ
@@ -1488,6 +3204,319 @@ private:
     CRecordBuf* m_pWriteBuf;
     // ļ¼л棨ڶ
     CRecordBuf* m_pReadBuf;
+    // дʹõڴ
+    CDbfBufPool* m_pBufPool;
+    CDbfBufPool m_oBufPool;
+    // ͳƣΪʱͳ
+    TDbfStats* m_pStats;
+    // һԶȡУ黺
+    std::vector<char> m_vecVerify;
+};
+
+// CPDbfټ̳CIDbfԱҲ麯ԭͨCIDbfָʹû̳дĴCDbfAdapter
+typedef BasicDbf<> CPDbf;
+
+// CIDbfҪʱ̬ĴͨʹBasicDbf
+// 磺CIDbf* pDbf = new CDbfAdapter<CPDbf>();
+template<class TDbf>
+class CDbfAdapter : public CIDbf
+{
+public:
+    // жļǷ
+    virtual bool IsOpen() { return m_oDbf.IsOpen(); }
+
+    // ļ
+    virtual int Open(const std::string& strFile, bool bReadOnly = true) { return m_oDbf.Open(strFile, bReadOnly); }
+
+    // رDBFļ
+    virtual void Close() { m_oDbf.Close(); }
+
+    // ļ¼
+    virtual size_t GetRecNum() { return m_oDbf.GetRecNum(); }
+    // ֶ
+    virtual size_t GetFieldNum() { return m_oDbf.GetFieldNum(); }
+
+    // ֱӲļܵͣ¼Ϊ0
+    virtual std::string ReadString(size_t nRecNo, const std::string& strName) { return m_oDbf.ReadString(nRecNo, strName); }
+    virtual int WriteString(size_t nRecNo, const std::string& strName, const std::string& strValue) { return m_oDbf.WriteString(nRecNo, strName, strValue); }
+    virtual int ReadField(size_t nRecNo, size_t nCol, std::string& strValue) { return m_oDbf.ReadField(nRecNo, nCol, strValue); }
+    virtual int Append(size_t nAppendNum) { return m_oDbf.Append(nAppendNum); }
+    virtual int WriteField(size_t nRecNo, size_t nCol, const std::string& strValue) { return m_oDbf.WriteField(nRecNo, nCol, strValue); }
+
+    // 洦ܸ
+    // ȡļ¼
+    // ȡ¼е
+    virtual int Read(size_t nRecNo, size_t nRecNum) { return m_oDbf.Read(nRecNo, nRecNum); }
+    // öָ, 0ʼ, ¼
+    virtual int ReadGo(size_t nRec) { return m_oDbf.ReadGo(nRec); }
+    // ȡֶ
+    virtual std::string ReadString(const std::string& strName) { return m_oDbf.ReadString(strName); }
+    virtual double ReadDouble(const std::string& strName) { return m_oDbf.ReadDouble(strName); }
+    virtual int ReadInt(const std::string& strName) { return m_oDbf.ReadInt(strName); }
+    virtual long ReadLong(const std::string& strName) { return m_oDbf.ReadLong(strName); }
+    virtual int ReadString(const std::string& strName, std::string& strValue) { return m_oDbf.ReadString(strName, strValue); }
+    virtual int ReadDouble(const std::string& strName, double& fValue) { return m_oDbf.ReadDouble(strName, fValue); }
+    virtual int ReadInt(const std::string& strName, int& nValue) { return m_oDbf.ReadInt(strName, nValue); }
+    virtual int ReadLong(const std::string& strName, long& nValue) { return m_oDbf.ReadLong(strName, nValue); }
+    virtual int ReadString(size_t nCol, std::string& strValue) { return m_oDbf.ReadString(nCol, strValue); }
+    virtual int ReadDouble(size_t nCol, double& fValue) { return m_oDbf.ReadDouble(nCol, fValue); }
+    virtual int ReadInt(size_t nCol, int& nValue) { return m_oDbf.ReadInt(nCol, nValue); }
+    virtual int ReadLong(size_t nCol, long& nValue) { return m_oDbf.ReadLong(nCol, nValue); }
+
+    // дļ¼
+    // 
+    virtual int Zap() { return m_oDbf.Zap(); }
+    // д
+    virtual int PrepareAppend(size_t nRecNum) { return m_oDbf.PrepareAppend(nRecNum); }
+    // ύдݵļ
+    virtual int WriteCommit() { return m_oDbf.WriteCommit(); }
+    // ύдݵļ
+    virtual int FileCommit() { return m_oDbf.FileCommit(); }
+    // дָ, 0ʼ, ¼
+    virtual int WriteGo(size_t nRec) { return m_oDbf.WriteGo(nRec); }
+    // ֶдֶ
+    virtual int WriteString(const std::string& strName, const std::string& strValue) { return m_oDbf.WriteString(strName, strValue); }
+    virtual int WriteDouble(const std::string& strName, double fValue) { return m_oDbf.WriteDouble(strName, fValue); }
+    virtual int WriteInt(const std::string& strName, int nValue) { return m_oDbf.WriteInt(strName, nValue); }
+    virtual int WriteLong(const std::string& strName, long nValue) { return m_oDbf.WriteLong(strName, nValue); }
+    // д
+    virtual int WriteString(size_t nCol, const std::string& strValue) { return m_oDbf.WriteString(nCol, strValue); }
+    virtual int WriteDouble(size_t nCol, double fValue) { return m_oDbf.WriteDouble(nCol, fValue); }
+    virtual int WriteInt(size_t nCol, int nValue) { return m_oDbf.WriteInt(nCol, nValue); }
+    virtual int WriteLong(size_t nCol, long nValue) { return m_oDbf.WriteLong(nCol, nValue); }
+
+    // Ķ󣬿ֱӵ÷ӿ
+    inline TDbf& Dbf() { return m_oDbf; }
+
+private:
+    TDbf m_oDbf;
+};
+
+// ڴDBFļӳֻͼӵ
+// ӳļһ(ļͷ+ֶ+ע+¼)Թڴ桢ڴյ
+class CDbfTableView
+{
+public:
+    CDbfTableView()
+    {
+        m_pImage = NULL;
+        m_nImageSize = 0;
+        m_pRecord = NULL;
+        m_nRemarkLen = 0;
+        m_nReadNo = 0;
+        m_nReadNum = 0;
+        m_nCurRec = 0;
+    }
+
+    // ļӳ񲢽ļͷֶ
+    int Attach(const char* pImage, size_t nSize)
+    {
+        Detach();
+        if (!pImage || nSize < sizeof(TDbfHeader))
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        TDbfHeader oHeader;
+        memcpy(&oHeader, pImage, sizeof(oHeader));
+        if (oHeader.nHeaderLen < sizeof(oHeader) || oHeader.nHeaderLen > nSize)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        std::vector<TDbfField> vecField;
+        std::map<std::string, size_t> mapField;
+        if (CPDbf::ParseField(pImage + sizeof(oHeader), oHeader.nHeaderLen - sizeof(oHeader), vecField, mapField))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nRemarkLen = CPDbf::GetRemarkSize(oHeader.cVer);
+        if (oHeader.nHeaderLen + nRemarkLen + (unsigned long long)oHeader.nRecNum * oHeader.nRecLen > nSize)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_pImage = pImage;
+        m_nImageSize = nSize;
+        m_oHeader = oHeader;
+        m_vecField.swap(vecField);
+        m_mapField.swap(mapField);
+        m_nRemarkLen = nRemarkLen;
+        m_pRecord = pImage + oHeader.nHeaderLen + nRemarkLen;
+        return CIDbf::DBF_SUCC;
+    }
+    void Detach()
+    {
+        m_pImage = NULL;
+        m_nImageSize = 0;
+        m_pRecord = NULL;
+        m_oHeader = TDbfHeader();
+        m_vecField.clear();
+        m_mapField.clear();
+        m_nReadNo = 0;
+        m_nReadNum = 0;
+        m_nCurRec = 0;
+    }
+
+    inline bool IsOpen() const { return m_pImage != NULL; }
+    inline size_t GetRecNum() const { return m_oHeader.nRecNum; }
+    inline size_t GetFieldNum() const { return m_vecField.size(); }
+    inline size_t GetRecLen() const { return m_oHeader.nRecLen; }
+    inline const TDbfHeader& GetHeader() const { return m_oHeader; }
+    inline const std::vector<TDbfField>& GetField() const { return m_vecField; }
+    // ļӳ
+    inline const char* Image() const { return m_pImage; }
+    inline size_t ImageSize() const { return m_nImageSize; }
+
+    // nRec¼ԭʼ
+    inline const char* Record(size_t nRec) const
+    {
+        return nRec < m_oHeader.nRecNum ? m_pRecord + nRec * m_oHeader.nRecLen : NULL;
+    }
+
+    // ֶλ
+    size_t FindField(const std::string& strField) const
+    {
+        std::map<std::string, size_t>::const_iterator e = m_mapField.find(strField);
+        if (e != m_mapField.end())
+        {
+            return e->second;
+        }
+        return -1;
+    }
+
+    // ¼ֱӶȡֶΣʹöָ룬ɶ߳ͬʱ
+    int ReadField(size_t nRecNo, size_t nCol, std::string& strValue) const
+    {
+        if (nRecNo >= m_oHeader.nRecNum || nCol >= m_vecField.size())
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        const TDbfField& oField = m_vecField[nCol];
+        strValue.assign(m_pRecord + nRecNo * m_oHeader.nRecLen + oField.nPosition, oField.cLength);
+        return CIDbf::DBF_SUCC;
+    }
+
+    // CPDbfһµĻȡӿڣ¼ڴУReadֻÿɶȡļ¼Χ
+    int Read(size_t nRecNo, size_t nRecNum)
+    {
+        if (!IsOpen())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (nRecNo + nRecNum > m_oHeader.nRecNum)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        m_nReadNo = nRecNo;
+        m_nReadNum = nRecNum;
+        m_nCurRec = nRecNo;
+        return CIDbf::DBF_SUCC;
+    }
+    // öָ룬0ʼReadʼ¼
+    int ReadGo(size_t nRec)
+    {
+        if (!IsOpen())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (nRec >= m_nReadNum)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        m_nCurRec = m_nReadNo + nRec;
+        return CIDbf::DBF_SUCC;
+    }
+    // еԭʼ¼
+    const char* ReadData(size_t nRec = 0) const
+    {
+        return nRec < m_nReadNum ? Record(m_nReadNo + nRec) : NULL;
+    }
+
+    // ȡǰ¼ֶ
+    int ReadString(size_t nCol, std::string& strValue) const
+    {
+        if (!IsOpen() || !m_nReadNum)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (nCol >= m_vecField.size())
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        const TDbfField& oField = m_vecField[nCol];
+        strValue.assign(m_pRecord + m_nCurRec * m_oHeader.nRecLen + oField.nPosition, oField.cLength);
+        return CIDbf::DBF_SUCC;
+    }
+    int ReadDouble(size_t nCol, double& fValue) const
+    {
+        std::string strField;
+        int nRet = ReadString(nCol, strField);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            fValue = atof(strField.c_str());
+        }
+        return nRet;
+    }
+    int ReadInt(size_t nCol, int& nValue) const
+    {
+        std::string strField;
+        int nRet = ReadString(nCol, strField);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nValue = atoi(strField.c_str());
+        }
+        return nRet;
+    }
+    int ReadLong(size_t nCol, long& nValue) const
+    {
+        std::string strField;
+        int nRet = ReadString(nCol, strField);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nValue = atol(strField.c_str());
+        }
+        return nRet;
+    }
+    int ReadString(const std::string& strName, std::string& strValue) const
+    {
+        return ReadString(FindField(strName), strValue);
+    }
+    int ReadDouble(const std::string& strName, double& fValue) const
+    {
+        return ReadDouble(FindField(strName), fValue);
+    }
+    int ReadInt(const std::string& strName, int& nValue) const
+    {
+        return ReadInt(FindField(strName), nValue);
+    }
+    int ReadLong(const std::string& strName, long& nValue) const
+    {
+        return ReadLong(FindField(strName), nValue);
+    }
+    std::string ReadString(const std::string& strName) const
+    {
+        std::string strValue;
+        ReadString(strName, strValue);
+        return strValue;
+    }
+
+private:
+    // ļӳ
+    const char* m_pImage;
+    size_t m_nImageSize;
+    // ¼ʼλ
+    const char* m_pRecord;
+    // ļͷϢ
+    TDbfHeader m_oHeader;
+    // ֶϢ
+    std::vector<TDbfField> m_vecField;
+    // ֶ
+    std::map<std::string, size_t> m_mapField;
+    // עϢ
+    size_t m_nRemarkLen;
+    // ȡΧ
+    size_t m_nReadNo;
+    size_t m_nReadNum;
+    // ǰ¼
+    size_t m_nCurRec;
 };
 
 class CCMPDbf
@@ -1499,20 +3528,23 @@ public:
         m_nMaxDiffs = 256;
         m_nCurDiffs = 0;
         m_nCurRowDiffs = 0;
+        m_bRawCmp = true;
     }
 public:
     // Ƚϵֶ
     std::vector<std::string> m_vecField;
-    // ֵ
+    // 
     size_t m_nMaxRowDiffs;
-    // ֵ
+    // 
     size_t m_nMaxDiffs;
     // ǰѷֵв
     size_t m_nCurRowDiffs;
     // ǰѷֵĲ
     size_t m_nCurDiffs;
+    // ֶβһʱԭʼݱȽϣԲֶͬαȽ
+    bool m_bRawCmp;
 
-    // ȽBDFļ򷵻true
+    // ȽBDFļ򷵻true
     bool Cmp(const std::string& strFile1, const std::string& strFile2)
     {
         CPDbf oDbf1;
@@ -1533,11 +3565,26 @@ public:
 
         // ȡֶβȽ
         size_t nRecNum1 = oDbf1.GetRecNum();
-        size_t nRecNum2 = oDbf1.GetRecNum();
+        size_t nRecNum2 = oDbf2.GetRecNum();
         size_t nRecNum = MMin(nRecNum1, nRecNum2);
         size_t nReadNum = 10000;
         m_nCurDiffs = 0;
         m_nCurRowDiffs = 0;
+        bool bRaw = m_bRawCmp && IsSameLayout(oDbf1, oDbf2);
+        std::vector<size_t> vecCol;
+        if (bRaw)
+        {
+            // ȽֶתΪֶţڵֶ߾ֵΪ
+            std::vector<TDbfField> vecField = oDbf1.GetField();
+            for (size_t k = 0; k < m_vecField.size(); k++)
+            {
+                size_t n = CPDbf::FindField(vecField, m_vecField[k]);
+                if (n < vecField.size())
+                {
+                    vecCol.push_back(n);
+                }
+            }
+        }
         bool bEq = false;
         std::string strBuf1;
         std::string strBuf2;
@@ -1552,12 +3599,19 @@ public:
                 return false;
             }
 
+            // бȽ
+            if (bRaw)
+            {
+                CmpRaw(oDbf1, oDbf2, nReadNum, vecCol);
+                continue;
+            }
+
             // ֶαȽ
             for (size_t j = 0; j < nReadNum; j++)
             {
                 bEq = true;
-                oDbf1.ReadGo(i + j);
-                oDbf2.ReadGo(i + j);
+                oDbf1.ReadGo(j);
+                oDbf2.ReadGo(j);
                 for (size_t k = 0; k < m_vecField.size(); k++)
                 {
                     strBuf1 = strBuf2 = "";
@@ -1586,7 +3640,87 @@ public:
         oDbf1.Close();
         oDbf2.Close();
 
-        return (m_nCurDiffs == 0 && m_nMaxDiffs == 0);
+        return m_nCurDiffs == 0;
+    }
+
+    // жļֶβǷһ(ֶ͡ȡȼ¼)
+    static bool IsSameLayout(CPDbf& oDbf1, CPDbf& oDbf2)
+    {
+        if (oDbf1.GetRecLen() != oDbf2.GetRecLen() || oDbf1.GetFieldNum() != oDbf2.GetFieldNum())
+        {
+            return false;
+        }
+        std::vector<TDbfField> vecField1 = oDbf1.GetField();
+        std::vector<TDbfField> vecField2 = oDbf2.GetField();
+        for (size_t i = 0; i < vecField1.size(); i++)
+        {
+            const TDbfField& oField1 = vecField1[i];
+            const TDbfField& oField2 = vecField2[i];
+            if (strncmp(oField1.szName, oField2.szName, sizeof(oField1.szName))
+                || oField1.cType != oField2.cType
+                || oField1.cLength != oField2.cLength
+                || oField1.cPrecisionLength != oField2.cPrecisionLength
+                || oField1.nPosition != oField2.nPosition)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // бȽ϶еļ¼ͬʱֱ
+    void CmpRaw(CPDbf& oDbf1, CPDbf& oDbf2, size_t nNum, const std::vector<size_t>& vecCol)
+    {
+        const char* pData1 = oDbf1.ReadData();
+        const char* pData2 = oDbf2.ReadData();
+        size_t nRecLen = oDbf1.GetRecLen();
+        if (!pData1 || !pData2 || memcmp(pData1, pData2, nNum * nRecLen) == 0)
+        {
+            return;
+        }
+
+        std::vector<TDbfField> vecField = oDbf1.GetField();
+        for (size_t j = 0; j < nNum; j++)
+        {
+            const char* pRec1 = pData1 + j * nRecLen;
+            const char* pRec2 = pData2 + j * nRecLen;
+            if (memcmp(pRec1, pRec2, nRecLen) == 0)
+            {
+                continue;
+            }
+            // Բͬȥհ׺ֶαȽ
+            bool bEq = true;
+            for (size_t k = 0; k < vecCol.size(); k++)
+            {
+                const TDbfField& oField = vecField[vecCol[k]];
+                if (!TrimEq(pRec1 + oField.nPosition, pRec2 + oField.nPosition, oField.cLength))
+                {
+                    m_nCurDiffs++;
+                    bEq = false;
+                }
+            }
+            if (!bEq)
+            {
+                m_nCurRowDiffs++;
+            }
+        }
+    }
+
+    // ȥβհ׺Ƚȳֶ
+    static bool TrimEq(const char* p1, const char* p2, size_t nLen)
+    {
+        size_t nBeg1 = 0, nEnd1 = nLen;
+        size_t nBeg2 = 0, nEnd2 = nLen;
+        while (nBeg1 < nEnd1 && isspace((unsigned char)p1[nBeg1])) nBeg1++;
+        while (nEnd1 > nBeg1 && isspace((unsigned char)p1[nEnd1 - 1])) nEnd1--;
+        while (nBeg2 < nEnd2 && isspace((unsigned char)p2[nBeg2])) nBeg2++;
+        while (nEnd2 > nBeg2 && isspace((unsigned char)p2[nEnd2 - 1])) nEnd2--;
+        if (nEnd1 - nBeg1 != nEnd2 - nBeg2)
+        {
+            return false;
+        }
+        return memcmp(p1 + nBeg1, p2 + nBeg2, nEnd1 - nBeg1) == 0;
     }
 };
 
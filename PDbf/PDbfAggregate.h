@@ -0,0 +1,644 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_AGGREGATE_H__
+#define __P_DBF_AGGREGATE_H__
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include "PDbf.h"
+#include "PDbfDigest.h"
+
+// ϣѰַ˳棬ʱؼ
+class CDbfKeyTable
+{
+public:
+    static const size_t npos = (size_t)-1;
+
+    CDbfKeyTable(size_t nKeyLen = 0)
+    {
+        Init(nKeyLen);
+    }
+    void Init(size_t nKeyLen)
+    {
+        m_nKeyLen = nKeyLen;
+        m_vecKey.clear();
+        m_vecHash.clear();
+        m_vecSlot.assign(1024, 0);
+        m_nMask = m_vecSlot.size() - 1;
+    }
+
+    // Ҽʱ룬bNewǷΪ²ļ
+    size_t Insert(const char* pKey, bool& bNew)
+    {
+        unsigned long long nHash = CXXHash64::Hash(pKey, m_nKeyLen);
+        size_t nSlot = (size_t)nHash & m_nMask;
+        while (m_vecSlot[nSlot])
+        {
+            size_t nIdx = m_vecSlot[nSlot] - 1;
+            if (m_vecHash[nIdx] == nHash && (m_nKeyLen == 0 || memcmp(Key(nIdx), pKey, m_nKeyLen) == 0))
+            {
+                bNew = false;
+                return nIdx;
+            }
+            nSlot = (nSlot + 1) & m_nMask;
+        }
+        // ¼
+        size_t nIdx = m_vecHash.size();
+        m_vecKey.insert(m_vecKey.end(), pKey, pKey + m_nKeyLen);
+        m_vecHash.push_back(nHash);
+        m_vecSlot[nSlot] = (unsigned int)(nIdx + 1);
+        bNew = true;
+        // ӳ1/2ʱ
+        if (m_vecHash.size() * 2 > m_vecSlot.size())
+        {
+            Grow();
+        }
+        return nIdx;
+    }
+    // Ҽʱnpos
+    size_t Find(const char* pKey) const
+    {
+        unsigned long long nHash = CXXHash64::Hash(pKey, m_nKeyLen);
+        size_t nSlot = (size_t)nHash & m_nMask;
+        while (m_vecSlot[nSlot])
+        {
+            size_t nIdx = m_vecSlot[nSlot] - 1;
+            if (m_vecHash[nIdx] == nHash && (m_nKeyLen == 0 || memcmp(Key(nIdx), pKey, m_nKeyLen) == 0))
+            {
+                return nIdx;
+            }
+            nSlot = (nSlot + 1) & m_nMask;
+        }
+        return npos;
+    }
+
+    inline size_t Size() const { return m_vecHash.size(); }
+    inline size_t KeyLen() const { return m_nKeyLen; }
+    inline const char* Key(size_t nIdx) const { return m_vecKey.data() + nIdx * m_nKeyLen; }
+
+private:
+    void Grow()
+    {
+        m_vecSlot.assign(m_vecSlot.size() * 2, 0);
+        m_nMask = m_vecSlot.size() - 1;
+        for (size_t i = 0; i < m_vecHash.size(); i++)
+        {
+            size_t nSlot = (size_t)m_vecHash[i] & m_nMask;
+            while (m_vecSlot[nSlot])
+            {
+                nSlot = (nSlot + 1) & m_nMask;
+            }
+            m_vecSlot[nSlot] = (unsigned int)(i + 1);
+        }
+    }
+
+private:
+    size_t m_nKeyLen;
+    // ݼϣֵŴ
+    std::vector<char> m_vecKey;
+    std::vector<unsigned long long> m_vecHash;
+    // λ+10Ϊ
+    std::vector<unsigned int> m_vecSlot;
+    size_t m_nMask;
+};
+
+// ۺϺ
+enum EDbfAggFunc
+{
+    DBF_AGG_SUM,    // 
+    DBF_AGG_COUNT,  // ¼
+    DBF_AGG_MIN,    // Сֵ
+    DBF_AGG_MAX,    // ֵ
+    DBF_AGG_AVG,    // ƽֵ
+};
+
+// ۺ
+class TDbfAggItem
+{
+public:
+    // ۺϺ
+    int nFunc;
+    // ֵֶCOUNTʱΪ
+    std::string strField;
+    // ֶΪʱԶɣSUM_QTY10ַҲ
+    std::string strName;
+
+    TDbfAggItem(int nAggFunc = DBF_AGG_COUNT, const std::string& strAggField = "", const std::string& strAggName = "")
+    {
+        nFunc = nAggFunc;
+        strField = strAggField;
+        strName = strAggName;
+    }
+};
+
+// ۺ
+// ļ¼Χָ̣̰߳߳ȡ¼ԭʼֽϣ飬
+// ֵֶΰۼӵ߳ڵķϲ߳̽
+// ɾ־Ϊ'*'ļ¼;ۺ
+// ֱӶȡ򱣴ΪµDBFļ(ֶ+ۺֶ)
+class CDbfAggregate
+{
+public:
+    CDbfAggregate()
+    {
+        m_nThreadNum = MMax(std::thread::hardware_concurrency(), 1U);
+        m_nBatchRecs = 64 * 1024;
+        m_nKeyLen = 0;
+        m_bKeyInPlace = true;
+        m_nRecLen = 0;
+        m_nStride = 0;
+        m_nOverflowNum = 0;
+    }
+
+    // vecKeyvecItemvecKeyΪʱļΪһ
+    int Aggregate(const std::string& strFile, const std::vector<std::string>& vecKey, const std::vector<TDbfAggItem>& vecItem)
+    {
+        Clear();
+        CPDbf oDbf;
+        if (oDbf.Open(strFile))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (Init(oDbf, vecKey, vecItem))
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        size_t nRecNum = oDbf.GetRecNum();
+        oDbf.Close();
+
+        // ¼Χָ߳
+        size_t nThread = MMax(MMin((size_t)m_nThreadNum, nRecNum / MMax(m_nBatchRecs, (size_t)1)), (size_t)1);
+        size_t nStep = (nRecNum + nThread - 1) / nThread;
+        std::vector<TPartial> vecPartial(nThread);
+        std::vector<std::thread> vecThread;
+        for (size_t t = 0; t < nThread; t++)
+        {
+            size_t nBegin = MMin(t * nStep, nRecNum);
+            size_t nEnd = MMin(nBegin + nStep, nRecNum);
+            vecThread.push_back(std::thread(&CDbfAggregate::Scan, this, strFile, nBegin, nEnd, &vecPartial[t]));
+        }
+        for (size_t t = 0; t < vecThread.size(); t++)
+        {
+            vecThread[t].join();
+        }
+        for (size_t t = 0; t < nThread; t++)
+        {
+            if (vecPartial[t].nRet)
+            {
+                return vecPartial[t].nRet;
+            }
+        }
+        Merge(vecPartial);
+        return CIDbf::DBF_SUCC;
+    }
+
+    // 
+    inline size_t GetGroupNum() const { return m_vecCount.size(); }
+    // ԭʼݣֶƴ
+    inline const char* GetKey(size_t nGroup) const { return m_vecKeyData.data() + nGroup * m_nKeyLen; }
+    // nKeyֶεԭʼ
+    std::string GetKeyField(size_t nGroup, size_t nKey) const
+    {
+        if (nKey >= m_vecKeyField.size())
+        {
+            return "";
+        }
+        return std::string(GetKey(nGroup) + m_vecKeyOffset[nKey], m_vecKeyField[nKey].cLength);
+    }
+    // nItemۺĽ
+    inline double GetValue(size_t nGroup, size_t nItem) const { return m_vecValue[nGroup * m_vecItem.size() + nItem]; }
+    // ¼
+    inline unsigned long long GetCount(size_t nGroup) const { return m_vecCount[nGroup]; }
+    // ֶζ(ֶ+ۺֶ)
+    std::vector<TDbfField> GetField() const
+    {
+        std::vector<TDbfField> vecField = m_vecKeyField;
+        vecField.insert(vecField.end(), m_vecOutField.begin(), m_vecOutField.end());
+        return vecField;
+    }
+
+    // һSaveгֶγ'*'ֵΪ0ʱûݶʧ
+    inline size_t GetOverflowNum() const { return m_nOverflowNum; }
+
+    // ΪDBFļ
+    int Save(const std::string& strFile)
+    {
+        m_nOverflowNum = 0;
+        CPDbf oDbf;
+        std::vector<TDbfField> vecField = GetField();
+        if (oDbf.Create(strFile, vecField))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nGroupNum = m_vecCount.size();
+        size_t nCol = vecField.size();
+        std::vector<TDbfValue> vecValue;
+        std::vector<char> vecText;
+        const size_t nBatch = 4096;
+        for (size_t nBegin = 0; nBegin < nGroupNum; nBegin += nBatch)
+        {
+            size_t nNum = MMin(nBatch, nGroupNum - nBegin);
+            vecValue.resize(nNum * nCol);
+            vecText.resize(nNum * m_vecItem.size() * 64 + 1);
+            for (size_t i = 0; i < nNum; i++)
+            {
+                size_t nGroup = nBegin + i;
+                TDbfValue* pRow = &vecValue[i * nCol];
+                for (size_t k = 0; k < m_vecKeyField.size(); k++)
+                {
+                    pRow[k] = TDbfValue(GetKey(nGroup) + m_vecKeyOffset[k], m_vecKeyField[k].cLength);
+                }
+                for (size_t j = 0; j < m_vecItem.size(); j++)
+                {
+                    const TDbfField& oField = m_vecOutField[j];
+                    char* pText = &vecText[(i * m_vecItem.size() + j) * 64];
+                    size_t nLen = CDbfDefaultParse::FormatDouble(pText, 64, GetValue(nGroup, j), oField.cLength, oField.cPrecisionLength);
+                    // ֶγʱضϻɴֵdBaseֶ'*'
+                    if (nLen > oField.cLength)
+                    {
+                        nLen = oField.cLength;
+                        memset(pText, '*', nLen);
+                        m_nOverflowNum++;
+                    }
+                    pRow[m_vecKeyField.size() + j] = TDbfValue(pText, nLen);
+                }
+            }
+            if (oDbf.AppendRows(vecValue, nCol) || oDbf.WriteCommit())
+            {
+                return CIDbf::DBF_ERROR;
+            }
+        }
+        return oDbf.FileCommit();
+    }
+
+public:
+    // ߳
+    unsigned int m_nThreadNum;
+    // ÿȡļ¼
+    size_t m_nBatchRecs;
+
+private:
+    // ߳ڵķ
+    class TPartial
+    {
+    public:
+        int nRet;
+        CDbfKeyTable oTable;
+        // ÿm_nStrideֵ¼ + ۺ
+        std::vector<double> vecAcc;
+
+        TPartial()
+        {
+            nRet = CIDbf::DBF_SUCC;
+        }
+    };
+
+    void Clear()
+    {
+        m_vecKeyField.clear();
+        m_vecKeyOffset.clear();
+        m_vecItem.clear();
+        m_vecOutField.clear();
+        m_vecKeyData.clear();
+        m_vecValue.clear();
+        m_vecCount.clear();
+    }
+
+    int Init(CPDbf& oDbf, const std::vector<std::string>& vecKey, const std::vector<TDbfAggItem>& vecItem)
+    {
+        std::vector<TDbfField> vecField = oDbf.GetField();
+        m_nRecLen = oDbf.GetRecLen();
+        m_nKeyLen = 0;
+        for (size_t i = 0; i < vecKey.size(); i++)
+        {
+            size_t nIdx = CPDbf::FindField(vecField, vecKey[i]);
+            if (nIdx == vecField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            m_vecKeyField.push_back(vecField[nIdx]);
+            m_vecKeyOffset.push_back(m_nKeyLen);
+            m_nKeyLen += vecField[nIdx].cLength;
+        }
+        // ֶڼ¼ʱֱʹü¼еֽڣ
+        m_bKeyInPlace = true;
+        for (size_t i = 1; i < m_vecKeyField.size(); i++)
+        {
+            if (m_vecKeyField[i].nPosition != m_vecKeyField[i - 1].nPosition + m_vecKeyField[i - 1].cLength)
+            {
+                m_bKeyInPlace = false;
+            }
+        }
+
+        m_vecItem = vecItem;
+        m_vecSrc.clear();
+        m_vecSrcField.clear();
+        m_vecItemSrc.clear();
+        for (size_t i = 0; i < vecItem.size(); i++)
+        {
+            static const char* s_pName[] = { "SUM_", "COUNT", "MIN_", "MAX_", "AVG_" };
+            if (vecItem[i].nFunc < DBF_AGG_SUM || vecItem[i].nFunc > DBF_AGG_AVG)
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            TDbfField oOut;
+            oOut.cType = 'N';
+            oOut.cLength = 20;
+            size_t nSrc = (size_t)-1;
+            if (vecItem[i].nFunc != DBF_AGG_COUNT)
+            {
+                size_t nIdx = CPDbf::FindField(vecField, vecItem[i].strField);
+                if (nIdx == vecField.size())
+                {
+                    return CIDbf::DBF_PARA_ERROR;
+                }
+                // ͬһֶֻһ
+                nSrc = std::find(m_vecSrc.begin(), m_vecSrc.end(), nIdx) - m_vecSrc.begin();
+                if (nSrc == m_vecSrc.size())
+                {
+                    m_vecSrc.push_back(nIdx);
+                    m_vecSrcField.push_back(vecField[nIdx]);
+                }
+                oOut.cPrecisionLength = vecField[nIdx].cPrecisionLength;
+                if (vecItem[i].nFunc == DBF_AGG_AVG)
+                {
+                    oOut.cPrecisionLength = (unsigned char)MMin(oOut.cPrecisionLength + 2, 8);
+                }
+            }
+            m_vecItemSrc.push_back(nSrc);
+            std::string strName = vecItem[i].strName;
+            if (strName.empty())
+            {
+                strName = s_pName[vecItem[i].nFunc];
+                if (vecItem[i].nFunc != DBF_AGG_COUNT)
+                {
+                    strName += vecItem[i].strField;
+                }
+            }
+            // ֶ10ֶַΡֶʱضϻظֶ
+            if (strName.size() >= sizeof(oOut.szName) || CPDbf::FindField(m_vecKeyField, strName) < m_vecKeyField.size() ||
+                CPDbf::FindField(m_vecOutField, strName) < m_vecOutField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            strncpy(oOut.szName, strName.c_str(), sizeof(oOut.szName) - 1);
+            m_vecOutField.push_back(oOut);
+        }
+        m_nStride = 1 + m_vecItem.size();
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ɨ[nBegin, nEnd)Χļ¼
+    void Scan(std::string strFile, size_t nBegin, size_t nEnd, TPartial* pPartial)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(strFile))
+        {
+            pPartial->nRet = CIDbf::DBF_FILE_ERROR;
+            return;
+        }
+        pPartial->oTable.Init(m_nKeyLen);
+        const size_t nBatch = MMax(m_nBatchRecs, (size_t)1);
+        std::vector<size_t> vecGroup(nBatch);
+        std::vector<const char*> vecRec(nBatch);
+        std::vector<double> vecCol(nBatch * m_vecSrc.size());
+        std::vector<char> vecKey(m_nKeyLen + 1);
+        for (size_t nRecNo = nBegin; nRecNo < nEnd; nRecNo += nBatch)
+        {
+            size_t nNum = MMin(nBatch, nEnd - nRecNo);
+            if (oDbf.Read(nRecNo, nNum))
+            {
+                pPartial->nRet = CIDbf::DBF_FILE_ERROR;
+                return;
+            }
+            const char* pData = oDbf.ReadData(0);
+            // 1.飬ɾļ¼nLiveΪЧ¼
+            size_t nLive = 0;
+            for (size_t i = 0; i < nNum; i++)
+            {
+                const char* pRec = pData + i * m_nRecLen;
+                if (*pRec == '*')
+                {
+                    continue;
+                }
+                const char* pKey = pRec + (m_vecKeyField.empty() ? 0 : m_vecKeyField[0].nPosition);
+                if (!m_bKeyInPlace)
+                {
+                    for (size_t k = 0; k < m_vecKeyField.size(); k++)
+                    {
+                        memcpy(&vecKey[m_vecKeyOffset[k]], pRec + m_vecKeyField[k].nPosition, m_vecKeyField[k].cLength);
+                    }
+                    pKey = &vecKey[0];
+                }
+                bool bNew = false;
+                size_t nGroup = pPartial->oTable.Insert(pKey, bNew);
+                if (bNew)
+                {
+                    NewGroup(pPartial->vecAcc);
+                }
+                vecGroup[nLive] = nGroup;
+                vecRec[nLive] = pRec;
+                nLive++;
+            }
+            // 2.нֵֶ
+            for (size_t c = 0; c < m_vecSrc.size(); c++)
+            {
+                const TDbfField& oField = m_vecSrcField[c];
+                double* pCol = &vecCol[c * nBatch];
+                for (size_t i = 0; i < nLive; i++)
+                {
+                    pCol[i] = CDbfFastParse::ToDouble(vecRec[i] + oField.nPosition, oField.cLength);
+                }
+            }
+            // 3.ۼ
+            double* pAcc = pPartial->vecAcc.empty() ? NULL : &pPartial->vecAcc[0];
+            for (size_t i = 0; i < nLive; i++)
+            {
+                pAcc[vecGroup[i] * m_nStride] += 1;
+            }
+            for (size_t j = 0; j < m_vecItem.size(); j++)
+            {
+                if (m_vecItem[j].nFunc == DBF_AGG_COUNT)
+                {
+                    continue;
+                }
+                const double* pCol = &vecCol[m_vecItemSrc[j] * nBatch];
+                double* pItem = pAcc + 1 + j;
+                switch (m_vecItem[j].nFunc)
+                {
+                case DBF_AGG_MIN:
+                    for (size_t i = 0; i < nLive; i++)
+                    {
+                        double& fAcc = pItem[vecGroup[i] * m_nStride];
+                        fAcc = MMin(fAcc, pCol[i]);
+                    }
+                    break;
+                case DBF_AGG_MAX:
+                    for (size_t i = 0; i < nLive; i++)
+                    {
+                        double& fAcc = pItem[vecGroup[i] * m_nStride];
+                        fAcc = MMax(fAcc, pCol[i]);
+                    }
+                    break;
+                default:
+                    for (size_t i = 0; i < nLive; i++)
+                    {
+                        pItem[vecGroup[i] * m_nStride] += pCol[i];
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // ·ĳʼֵ
+    void NewGroup(std::vector<double>& vecAcc) const
+    {
+        vecAcc.push_back(0);
+        for (size_t j = 0; j < m_vecItem.size(); j++)
+        {
+            double fInit = 0;
+            if (m_vecItem[j].nFunc == DBF_AGG_MIN)
+            {
+                fInit = std::numeric_limits<double>::infinity();
+            }
+            else if (m_vecItem[j].nFunc == DBF_AGG_MAX)
+            {
+                fInit = -std::numeric_limits<double>::infinity();
+            }
+            vecAcc.push_back(fInit);
+        }
+    }
+
+    // ϲ߳̽
+    void Merge(std::vector<TPartial>& vecPartial)
+    {
+        CDbfKeyTable oTable(m_nKeyLen);
+        std::vector<double> vecAcc;
+        for (size_t t = 0; t < vecPartial.size(); t++)
+        {
+            TPartial& oPartial = vecPartial[t];
+            for (size_t g = 0; g < oPartial.oTable.Size(); g++)
+            {
+                bool bNew = false;
+                size_t nGroup = oTable.Insert(oPartial.oTable.Key(g), bNew);
+                if (bNew)
+                {
+                    NewGroup(vecAcc);
+                }
+                double* pDst = &vecAcc[nGroup * m_nStride];
+                const double* pSrc = &oPartial.vecAcc[g * m_nStride];
+                pDst[0] += pSrc[0];
+                for (size_t j = 0; j < m_vecItem.size(); j++)
+                {
+                    if (m_vecItem[j].nFunc == DBF_AGG_MIN)
+                    {
+                        pDst[1 + j] = MMin(pDst[1 + j], pSrc[1 + j]);
+                    }
+                    else if (m_vecItem[j].nFunc == DBF_AGG_MAX)
+                    {
+                        pDst[1 + j] = MMax(pDst[1 + j], pSrc[1 + j]);
+                    }
+                    else
+                    {
+                        pDst[1 + j] += pSrc[1 + j];
+                    }
+                }
+            }
+        }
+
+        // 
+        std::vector<size_t> vecOrder(oTable.Size());
+        for (size_t i = 0; i < vecOrder.size(); i++)
+        {
+            vecOrder[i] = i;
+        }
+        CKeyLess oLess(oTable);
+        std::sort(vecOrder.begin(), vecOrder.end(), oLess);
+
+        size_t nItem = m_vecItem.size();
+        m_vecKeyData.resize(vecOrder.size() * m_nKeyLen);
+        m_vecValue.resize(vecOrder.size() * nItem);
+        m_vecCount.resize(vecOrder.size());
+        for (size_t i = 0; i < vecOrder.size(); i++)
+        {
+            if (m_nKeyLen)
+            {
+                memcpy(&m_vecKeyData[i * m_nKeyLen], oTable.Key(vecOrder[i]), m_nKeyLen);
+            }
+            const double* pAcc = &vecAcc[vecOrder[i] * m_nStride];
+            m_vecCount[i] = (unsigned long long)pAcc[0];
+            for (size_t j = 0; j < nItem; j++)
+            {
+                double fValue = pAcc[1 + j];
+                if (m_vecItem[j].nFunc == DBF_AGG_COUNT)
+                {
+                    fValue = pAcc[0];
+                }
+                else if (m_vecItem[j].nFunc == DBF_AGG_AVG)
+                {
+                    fValue = pAcc[0] ? fValue / pAcc[0] : 0;
+                }
+                m_vecValue[i * nItem + j] = fValue;
+            }
+        }
+    }
+    class CKeyLess
+    {
+    public:
+        CKeyLess(const CDbfKeyTable& oTable)
+            : m_oTable(oTable)
+        {
+        }
+        bool operator()(size_t a, size_t b) const
+        {
+            return m_oTable.KeyLen() && memcmp(m_oTable.Key(a), m_oTable.Key(b), m_oTable.KeyLen()) < 0;
+        }
+    private:
+        const CDbfKeyTable& m_oTable;
+    };
+
+private:
+    // ֶμڷеƫ
+    std::vector<TDbfField> m_vecKeyField;
+    std::vector<size_t> m_vecKeyOffset;
+    size_t m_nKeyLen;
+    bool m_bKeyInPlace;
+    size_t m_nRecLen;
+    // ۺֵֶΡۺӦĽ
+    std::vector<TDbfAggItem> m_vecItem;
+    std::vector<size_t> m_vecSrc;
+    std::vector<TDbfField> m_vecSrcField;
+    std::vector<size_t> m_vecItemSrc;
+    std::vector<TDbfField> m_vecOutField;
+    size_t m_nStride;
+    // ʱֵ
+    size_t m_nOverflowNum;
+    // 
+    std::vector<char> m_vecKeyData;
+    std::vector<double> m_vecValue;
+    std::vector<unsigned long long> m_vecCount;
+};
+
+#endif
@@ -0,0 +1,401 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_APPENDER_H__
+#define __P_DBF_APPENDER_H__
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "PDbf.h"
+#include "../HighlyConcurrent/concurrentqueue/concurrentqueue.h"
+#include "../HighlyConcurrent/concurrentqueue/lightweightsemaphore.h"
+
+// ߳׷ͬһDBFļ
+// ߳ͨAppendRow/AppendRowsύ¼¼ڵ߳иʽдУ
+// һд߳ȡƴһһдļļͷ(ύ)֮䲻ټ
+// δдļ¼ﵽm_nMaxPendingʱڴռ
+// ÿ¼Ǽʱȡõţд߳άŽȣFlushֻȴʱѵǼǵļ¼
+class CDbfAppender
+{
+public:
+    // еļ¼Ǽ
+    class TRecord
+    {
+    public:
+        unsigned long long nSeq;
+        std::string strRec;
+
+        TRecord()
+        {
+            nSeq = 0;
+        }
+    };
+    typedef moodycamel::ConcurrentQueue<TRecord> TQueue;
+    typedef moodycamel::LightweightSemaphore TSemaphore;
+
+    // ߾ÿ̴߳һжеƣͬһ̵߳ļ¼ύ˳д
+    // CDbfAppenderǰ٣̹ܿ߳
+    class CProducer
+    {
+    public:
+        explicit CProducer(CDbfAppender& oAppender)
+            : m_oAppender(oAppender), m_oToken(oAppender.m_oQueue)
+        {
+        }
+        int AppendRow(const TDbfValue* pValue, size_t nNum)
+        {
+            return m_oAppender.Push(&m_oToken, pValue, nNum, 1);
+        }
+        int AppendRows(const TDbfValue* pValue, size_t nCol, size_t nRow)
+        {
+            return m_oAppender.Push(&m_oToken, pValue, nCol, nRow);
+        }
+        // ׷ԭʼ¼(ɾ־)nNumΪ¼
+        int AppendRecord(const char* pData, size_t nNum)
+        {
+            return m_oAppender.PushRecord(&m_oToken, pData, nNum);
+        }
+    private:
+        CProducer(const CProducer&);
+        CProducer& operator=(const CProducer&);
+        CDbfAppender& m_oAppender;
+        moodycamel::ProducerToken m_oToken;
+    };
+
+    CDbfAppender()
+    {
+        m_nMaxPending = 65536;
+        m_nBatchRecs = 8192;
+        m_nRecLen = 0;
+        m_bOpen = false;
+        m_bStop = false;
+        m_nError = CIDbf::DBF_SUCC;
+        m_nReserved = 0;
+        m_nDone = 0;
+        m_nDoneSeq = 0;
+        m_nWritten = 0;
+    }
+    ~CDbfAppender()
+    {
+        Close();
+    }
+public:
+    // δдļ¼ﵽʱOpenǰ
+    size_t m_nMaxPending;
+    // ÿύ¼
+    size_t m_nBatchRecs;
+
+    // дʽѴڵļд̣߳¼¼׷ļĩβ
+    int Open(const std::string& strFile)
+    {
+        Close();
+        if (m_oDbf.Open(strFile, false))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_vecField = m_oDbf.GetField();
+        m_nRecLen = m_oDbf.GetRecLen();
+        m_nError = CIDbf::DBF_SUCC;
+        m_nReserved = 0;
+        m_nDone = 0;
+        m_nDoneSeq = 0;
+        m_mapDone.clear();
+        m_nWritten = 0;
+        m_bStop = false;
+        // ÿÿռ
+        while (m_oSpace.tryWaitMany(1 << 30) > 0)
+        {
+        }
+        m_oSpace.signal((TSemaphore::ssize_t)MMax(m_nMaxPending, (size_t)1));
+        m_bOpen = true;
+        m_oWriter = std::thread(&CDbfAppender::Run, this);
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ȴʱѵǼǵļ¼дļд߳ĵһ
+    // ǰѷصAppendRow/AppendRows(߳)ļ¼ڷʱд룻
+    // ԵʱĵǼΪƱţȵȴﵽƱżأ̳߳׷ʱһֱȴ
+    int Flush()
+    {
+        if (!m_bOpen)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        unsigned long long nTicket = m_nReserved;
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        m_oCond.wait(oLock, [this, nTicket]() { return m_nDoneSeq >= nTicket; });
+        return m_nError;
+    }
+
+    // ֹͣ¼¼ȴеļ¼ȫдд־رļ
+    int Close()
+    {
+        if (!m_bOpen)
+        {
+            return CIDbf::DBF_SUCC;
+        }
+        m_bStop = true;
+        if (m_oWriter.joinable())
+        {
+            m_oWriter.join();
+        }
+        m_bOpen = false;
+        int nRet = m_nError;
+        if (!nRet && m_oDbf.FileCommit())
+        {
+            nRet = CIDbf::DBF_ERROR;
+        }
+        m_oDbf.Close();
+        return nRet;
+    }
+
+    // ʹ߾׷ӣа߳ʽߣƵʱӦʹCProducer
+    int AppendRow(const TDbfValue* pValue, size_t nNum)
+    {
+        return Push(NULL, pValue, nNum, 1);
+    }
+    int AppendRows(const TDbfValue* pValue, size_t nCol, size_t nRow)
+    {
+        return Push(NULL, pValue, nCol, nRow);
+    }
+    int AppendRecord(const char* pData, size_t nNum)
+    {
+        return PushRecord(NULL, pData, nNum);
+    }
+
+    inline bool IsOpen() const { return m_bOpen; }
+    // д߳ĵһ󣬳¼
+    inline int GetError() const { return m_nError; }
+    // дļļ¼
+    inline size_t GetWriteNum() const { return m_nWritten; }
+    // ύδļ¼
+    inline size_t GetPending() const { return (size_t)(m_nReserved - m_nDone); }
+    inline const std::vector<TDbfField>& GetField() const { return m_vecField; }
+    inline size_t GetRecLen() const { return m_nRecLen; }
+
+private:
+    // ֶθʽ¼
+    int Push(moodycamel::ProducerToken* pToken, const TDbfValue* pValue, size_t nCol, size_t nRow)
+    {
+        if (!m_bOpen)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (nCol > m_vecField.size() || (!pValue && nCol && nRow))
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        std::vector<TRecord> vecRec(nRow);
+        const size_t nField = m_vecField.size();
+        for (size_t i = 0; i < nRow; i++, pValue += nCol)
+        {
+            // ɾ־ֶ
+            std::string& strRec = vecRec[i].strRec;
+            strRec.assign(m_nRecLen, ' ');
+            for (size_t j = 0; j < nCol && j < nField; j++)
+            {
+                size_t nSize = MMin((size_t)m_vecField[j].cLength, pValue[j].nLen);
+                if (nSize)
+                {
+                    memcpy(&strRec[m_vecField[j].nPosition], pValue[j].pData, nSize);
+                }
+            }
+        }
+        return Enqueue(pToken, vecRec);
+    }
+    int PushRecord(moodycamel::ProducerToken* pToken, const char* pData, size_t nNum)
+    {
+        if (!m_bOpen)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (!pData && nNum)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        std::vector<TRecord> vecRec(nNum);
+        for (size_t i = 0; i < nNum; i++)
+        {
+            vecRec[i].strRec.assign(pData + i * m_nRecLen, m_nRecLen);
+        }
+        return Enqueue(pToken, vecRec);
+    }
+
+    // ÿռֶεǼźӣռ䲻ʱ
+    int Enqueue(moodycamel::ProducerToken* pToken, std::vector<TRecord>& vecRec)
+    {
+        size_t nPos = 0;
+        while (nPos < vecRec.size())
+        {
+            if (m_nError)
+            {
+                return m_nError;
+            }
+            size_t nNum = (size_t)m_oSpace.waitMany((TSemaphore::ssize_t)(vecRec.size() - nPos));
+            // ȵǼټرձ־д߳̾ݴжǷ;¼
+            unsigned long long nSeq = m_nReserved.fetch_add(nNum);
+            for (size_t i = 0; i < nNum; i++)
+            {
+                vecRec[nPos + i].nSeq = nSeq + i;
+            }
+            if (m_bStop)
+            {
+                Finish(&vecRec[nPos], nNum, false);
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            std::move_iterator<std::vector<TRecord>::iterator> itBegin(vecRec.begin() + nPos);
+            bool bOk = pToken ? m_oQueue.enqueue_bulk(*pToken, itBegin, nNum) : m_oQueue.enqueue_bulk(itBegin, nNum);
+            if (!bOk)
+            {
+                Finish(&vecRec[nPos], nNum, false);
+                return CIDbf::DBF_CACHE_ERROR;
+            }
+            m_oItems.signal((TSemaphore::ssize_t)nNum);
+            nPos += nNum;
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // еǼǵļ¼ѴȶѴٶǼ
+    bool IsIdle() const
+    {
+        unsigned long long nDone = m_nDone;
+        return nDone == m_nReserved;
+    }
+
+    // nNum¼ϣǼŲƽȣͷŶпռ䲢ѵȴFlush߳
+    // ͬһߵļ¼˳ӣźϲɶκٵǼ
+    void Finish(const TRecord* pRec, size_t nNum, bool bWritten)
+    {
+        if (bWritten)
+        {
+            m_nWritten += nNum;
+        }
+        {
+            std::lock_guard<std::mutex> oLock(m_oMutex);
+            for (size_t i = 0; i < nNum; )
+            {
+                size_t j = i + 1;
+                while (j < nNum && pRec[j].nSeq == pRec[j - 1].nSeq + 1)
+                {
+                    j++;
+                }
+                m_mapDone[pRec[i].nSeq] = pRec[j - 1].nSeq + 1;
+                i = j;
+            }
+            std::map<unsigned long long, unsigned long long>::iterator it = m_mapDone.begin();
+            while (it != m_mapDone.end() && it->first == m_nDoneSeq)
+            {
+                m_nDoneSeq = it->second;
+                m_mapDone.erase(it++);
+            }
+            m_nDone += nNum;
+        }
+        m_oSpace.signal((TSemaphore::ssize_t)nNum);
+        m_oCond.notify_all();
+    }
+
+    // д̣߳ȡ¼һдļ
+    void Run()
+    {
+        size_t nBatch = MMax(m_nBatchRecs, (size_t)1);
+        std::vector<TRecord> vecRec(nBatch);
+        std::vector<char> vecBuf;
+        moodycamel::ConsumerToken oToken(m_oQueue);
+        while (true)
+        {
+            // ʱÿ10һιرձ־
+            size_t nNum = (size_t)m_oItems.waitMany((TSemaphore::ssize_t)nBatch, 10000);
+            if (nNum == 0)
+            {
+                if (m_bStop && IsIdle())
+                {
+                    break;
+                }
+                continue;
+            }
+            // źӦļ¼ӣѭֱȫȡ
+            for (size_t nGot = 0; nGot < nNum; )
+            {
+                nGot += m_oQueue.try_dequeue_bulk(oToken, vecRec.begin() + nGot, nNum - nGot);
+            }
+            if (m_nError)
+            {
+                Finish(&vecRec[0], nNum, false);
+                continue;
+            }
+            vecBuf.resize(nNum * m_nRecLen);
+            for (size_t i = 0; i < nNum; i++)
+            {
+                memcpy(&vecBuf[i * m_nRecLen], vecRec[i].strRec.data(), m_nRecLen);
+            }
+            int nRet = m_oDbf.WriteRecord(m_oDbf.GetRecNum(), &vecBuf[0], nNum);
+            if (!nRet && m_oDbf.Flush())
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+            if (nRet)
+            {
+                m_nError = nRet;
+            }
+            Finish(&vecRec[0], nNum, !nRet);
+        }
+    }
+
+private:
+    CDbfAppender(const CDbfAppender&);
+    CDbfAppender& operator=(const CDbfAppender&);
+
+    // ׷ӵļֻд̷߳
+    CPDbf m_oDbf;
+    std::vector<TDbfField> m_vecField;
+    size_t m_nRecLen;
+    // ʽļ¼
+    TQueue m_oQueue;
+    // ʣռ(¼)
+    TSemaphore m_oSpace;
+    // пȡļ¼
+    TSemaphore m_oItems;
+    std::thread m_oWriter;
+    // ȴFlush
+    std::mutex m_oMutex;
+    std::condition_variable m_oCond;
+    std::atomic<bool> m_bOpen;
+    std::atomic<bool> m_bStop;
+    std::atomic<int> m_nError;
+    // Ǽӵļ¼һ¼
+    std::atomic<unsigned long long> m_nReserved;
+    // Ѵ(д)ļ¼
+    std::atomic<unsigned long long> m_nDone;
+    // ȣСڸֵžѴm_oMutex
+    unsigned long long m_nDoneSeq;
+    // Ѵǰ滹δŵĶΣʼ->ţm_oMutex
+    std::map<unsigned long long, unsigned long long> m_mapDone;
+    // дļļ¼
+    std::atomic<size_t> m_nWritten;
+};
+
+#endif
@@ -0,0 +1,705 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_ARCHIVE_H__
+#define __P_DBF_ARCHIVE_H__
+#include <thread>
+#include "PDbf.h"
+
+// 򵥵LZ77ѹʽLZ4ʽͬ
+//  = (4λȣ4λƥ䳤-4) + [չ] +  + ƫ(2ֽС) + [չ]
+// һֻ
+class CDbfLz
+{
+public:
+    // ѹ󳤶
+    static size_t Bound(size_t nSize)
+    {
+        return nSize + nSize / 255 + 16;
+    }
+
+    // ѹѹĳȣʱ0
+    static size_t Compress(const char* pSrc, size_t nSize, char* pDst, size_t nCapacity)
+    {
+        const unsigned char* pIn = (const unsigned char*)pSrc;
+        unsigned char* pOut = (unsigned char*)pDst;
+        unsigned char* pOutEnd = pOut + nCapacity;
+        size_t nAnchor = 0;
+        if (nSize >= MF_LIMIT)
+        {
+            std::vector<unsigned int> vecTable(1 << HASH_BITS, 0);
+            size_t nLimit = nSize - MF_LIMIT;
+            size_t nMatchLimit = nSize - LAST_LITERALS;
+            size_t nPos = 0;
+            while (nPos <= nLimit)
+            {
+                unsigned int nSeq = Read32(pIn + nPos);
+                unsigned int& nRef = vecTable[Hash(nSeq)];
+                size_t nCand = nRef;
+                nRef = (unsigned int)nPos;
+                if (nCand >= nPos || nPos - nCand > MAX_OFFSET || Read32(pIn + nCand) != nSeq)
+                {
+                    nPos++;
+                    continue;
+                }
+                size_t nLen = MIN_MATCH;
+                while (nPos + nLen < nMatchLimit && pIn[nCand + nLen] == pIn[nPos + nLen])
+                {
+                    nLen++;
+                }
+                pOut = WriteSequence(pOut, pOutEnd, pIn + nAnchor, nPos - nAnchor, nPos - nCand, nLen);
+                if (pOut == NULL)
+                {
+                    return 0;
+                }
+                nPos += nLen;
+                nAnchor = nPos;
+            }
+        }
+        pOut = WriteSequence(pOut, pOutEnd, pIn + nAnchor, nSize - nAnchor, 0, 0);
+        return pOut == NULL ? 0 : pOut - (unsigned char*)pDst;
+    }
+
+    // ѹ𻵻򳤶Ȳʱfalse
+    static bool Decompress(const char* pSrc, size_t nSize, char* pDst, size_t nRawSize)
+    {
+        const unsigned char* pIn = (const unsigned char*)pSrc;
+        unsigned char* pOut = (unsigned char*)pDst;
+        size_t nIn = 0;
+        size_t nOut = 0;
+        while (nIn < nSize)
+        {
+            unsigned char cToken = pIn[nIn++];
+            size_t nLiteral = cToken >> 4;
+            if (nLiteral == 15 && !ReadLength(pIn, nSize, nIn, nLiteral))
+            {
+                return false;
+            }
+            if (nLiteral > nSize - nIn || nLiteral > nRawSize - nOut)
+            {
+                return false;
+            }
+            memcpy(pOut + nOut, pIn + nIn, nLiteral);
+            nIn += nLiteral;
+            nOut += nLiteral;
+            if (nIn == nSize)
+            {
+                break;
+            }
+            if (nSize - nIn < 2)
+            {
+                return false;
+            }
+            size_t nOffset = pIn[nIn] | (pIn[nIn + 1] << 8);
+            nIn += 2;
+            size_t nLen = cToken & 15;
+            if (nLen == 15 && !ReadLength(pIn, nSize, nIn, nLen))
+            {
+                return false;
+            }
+            nLen += MIN_MATCH;
+            if (nOffset == 0 || nOffset > nOut || nLen > nRawSize - nOut)
+            {
+                return false;
+            }
+            unsigned char* pMatch = pOut + nOut - nOffset;
+            if (nOffset >= nLen)
+            {
+                memcpy(pOut + nOut, pMatch, nLen);
+            }
+            else
+            {
+                // صƣĿո
+                for (size_t i = 0; i < nLen; i++)
+                {
+                    pOut[nOut + i] = pMatch[i];
+                }
+            }
+            nOut += nLen;
+        }
+        return nOut == nRawSize;
+    }
+
+private:
+    enum
+    {
+        MIN_MATCH = 4,
+        LAST_LITERALS = 5,
+        MF_LIMIT = 12,
+        MAX_OFFSET = 65535,
+        HASH_BITS = 14,
+    };
+
+    static inline unsigned int Read32(const unsigned char* p)
+    {
+        unsigned int n;
+        memcpy(&n, p, sizeof(n));
+        return n;
+    }
+    static inline size_t Hash(unsigned int nSeq)
+    {
+        return (nSeq * 2654435761U) >> (32 - HASH_BITS);
+    }
+    static bool ReadLength(const unsigned char* pIn, size_t nSize, size_t& nIn, size_t& nLen)
+    {
+        unsigned char c = 255;
+        while (c == 255)
+        {
+            if (nIn >= nSize)
+            {
+                return false;
+            }
+            c = pIn[nIn++];
+            nLen += c;
+        }
+        return true;
+    }
+    static unsigned char* WriteLength(unsigned char* pOut, size_t nLen)
+    {
+        for (; nLen >= 255; nLen -= 255)
+        {
+            *pOut++ = 255;
+        }
+        *pOut++ = (unsigned char)nLen;
+        return pOut;
+    }
+    // дһУnMatchΪ0ʱֻд
+    static unsigned char* WriteSequence(unsigned char* pOut, unsigned char* pOutEnd, const unsigned char* pLiteral, size_t nLiteral,
+        size_t nOffset, size_t nMatch)
+    {
+        if ((size_t)(pOutEnd - pOut) < 1 + nLiteral / 255 + 1 + nLiteral + 2 + (nMatch / 255) + 1)
+        {
+            return NULL;
+        }
+        unsigned char* pToken = pOut++;
+        *pToken = (unsigned char)(MMin(nLiteral, (size_t)15) << 4);
+        if (nLiteral >= 15)
+        {
+            pOut = WriteLength(pOut, nLiteral - 15);
+        }
+        memcpy(pOut, pLiteral, nLiteral);
+        pOut += nLiteral;
+        if (nMatch)
+        {
+            *pOut++ = (unsigned char)(nOffset & 0xFF);
+            *pOut++ = (unsigned char)(nOffset >> 8);
+            nMatch -= MIN_MATCH;
+            *pToken |= (unsigned char)MMin(nMatch, (size_t)15);
+            if (nMatch >= 15)
+            {
+                pOut = WriteLength(pOut, nMatch - 15);
+            }
+        }
+        return pOut;
+    }
+};
+
+// ѹ鵵ļͷ(64ֽ)
+class TDbfArchiveHeader
+{
+public:
+    char szMagic[4];                // "PDBA"
+    unsigned int nVersion;          // 汾
+    unsigned long long nRecNum;     // ¼
+    unsigned long long nIndexOffset;// ƫ
+    unsigned int nBlockRecs;        // ÿ¼
+    unsigned int nBlockNum;         // 
+    unsigned int nDbfHeaderLen;     // DBFļͷ(ֶμע)
+    unsigned int nRecLen;           // ¼
+    char szReserved[24];
+
+    TDbfArchiveHeader()
+    {
+        assert(sizeof(*this) == 64);
+        memset(this, 0, sizeof(*this));
+        memcpy(szMagic, "PDBA", 4);
+        nVersion = 1;
+    }
+};
+
+// 
+class TDbfArchiveBlock
+{
+public:
+    unsigned long long nOffset;     // ļеƫ
+    unsigned int nSize;             // ѹ󳤶ȣԭʼʱΪδѹ
+    unsigned int nRawSize;          // ԭʼ
+
+    TDbfArchiveBlock()
+    {
+        nOffset = 0;
+        nSize = 0;
+        nRawSize = 0;
+    }
+};
+
+// ѹ鵵
+// ļṹ鵵ͷ + DBFļͷԭ + ѹ + ¼ѹȰֶתΪдţ
+// ͬһֶεĿոһѹԶڰѹȡʱֻѹ漰Ŀ飬ʱнѹ
+class CDbfArchive
+{
+public:
+    CDbfArchive()
+    {
+        m_nThreadNum = MMax(std::thread::hardware_concurrency(), 1U);
+        m_nBlockRecs = 16 * 1024;
+        m_nRecNo = 0;
+        m_nRecNum = 0;
+        m_nCacheBlock = (size_t)-1;
+    }
+
+    // DBFļѹΪ鵵ļ
+    int Compress(const std::string& strDbf, const std::string& strArchive)
+    {
+        std::vector<char> vecHead;
+        if (ReadDbfHead(strDbf, vecHead))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        CPDbf oDbf;
+        if (oDbf.Open(strDbf))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        TDbfArchiveHeader oHeader;
+        oHeader.nRecNum = oDbf.GetRecNum();
+        oHeader.nBlockRecs = (unsigned int)MMax(m_nBlockRecs, (size_t)1);
+        oHeader.nBlockNum = (unsigned int)((oHeader.nRecNum + oHeader.nBlockRecs - 1) / oHeader.nBlockRecs);
+        oHeader.nDbfHeaderLen = (unsigned int)vecHead.size();
+        oHeader.nRecLen = (unsigned int)oDbf.GetRecLen();
+        std::vector<TDbfField> vecField = oDbf.GetField();
+        std::vector<TSegment> vecSeg = MakeSegment(vecField, oHeader.nRecLen);
+
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strArchive.c_str(), "wb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        // 鵵ͷд룬;ʧܵļ޷
+        TDbfArchiveHeader oEmpty;
+        memset(oEmpty.szMagic, 0, sizeof(oEmpty.szMagic));
+        int nRet = CIDbf::DBF_SUCC;
+        unsigned long long nOffset = sizeof(oHeader) + vecHead.size();
+        if (fwrite(&oEmpty, 1, sizeof(oEmpty), pFile) != sizeof(oEmpty) || fwrite(&vecHead[0], 1, vecHead.size(), pFile) != vecHead.size())
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        // ÿֶm_nThreadNum鲢ѹٰ˳д
+        size_t nThreadNum = MMax(m_nThreadNum, (size_t)1);
+        std::vector<TDbfArchiveBlock> vecBlock(oHeader.nBlockNum);
+        std::vector<std::vector<char> > vecOut(nThreadNum);
+        for (size_t nBlock = 0; nBlock < oHeader.nBlockNum && nRet == CIDbf::DBF_SUCC; nBlock += nThreadNum)
+        {
+            size_t nRecNo = nBlock * oHeader.nBlockRecs;
+            size_t nRecNum = (size_t)MMin((unsigned long long)nThreadNum * oHeader.nBlockRecs, oHeader.nRecNum - nRecNo);
+            if (oDbf.Read(nRecNo, nRecNum))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+                break;
+            }
+            size_t nNum = (nRecNum + oHeader.nBlockRecs - 1) / oHeader.nBlockRecs;
+            std::vector<std::thread> vecThread;
+            for (size_t i = 0; i < nNum; i++)
+            {
+                size_t nBlockRecNum = MMin((size_t)oHeader.nBlockRecs, nRecNum - i * oHeader.nBlockRecs);
+                const char* pData = oDbf.ReadData(i * oHeader.nBlockRecs);
+                if (nNum == 1)
+                {
+                    CompressBlock(pData, nBlockRecNum, oHeader.nRecLen, vecSeg, vecOut[i]);
+                }
+                else
+                {
+                    vecThread.push_back(std::thread(&CDbfArchive::CompressBlock, pData, nBlockRecNum, (size_t)oHeader.nRecLen,
+                        std::cref(vecSeg), std::ref(vecOut[i])));
+                }
+            }
+            for (size_t i = 0; i < vecThread.size(); i++)
+            {
+                vecThread[i].join();
+            }
+            for (size_t i = 0; i < nNum && nRet == CIDbf::DBF_SUCC; i++)
+            {
+                TDbfArchiveBlock& oBlock = vecBlock[nBlock + i];
+                oBlock.nOffset = nOffset;
+                oBlock.nSize = (unsigned int)vecOut[i].size();
+                oBlock.nRawSize = (unsigned int)(MMin((size_t)oHeader.nBlockRecs, nRecNum - i * oHeader.nBlockRecs) * oHeader.nRecLen);
+                if (fwrite(&vecOut[i][0], 1, vecOut[i].size(), pFile) != vecOut[i].size())
+                {
+                    nRet = CIDbf::DBF_FILE_ERROR;
+                }
+                nOffset += oBlock.nSize;
+            }
+        }
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            oHeader.nIndexOffset = nOffset;
+            if ((!vecBlock.empty() && fwrite(&vecBlock[0], sizeof(TDbfArchiveBlock), vecBlock.size(), pFile) != vecBlock.size())
+                || fseek(pFile, 0, SEEK_SET) || fwrite(&oHeader, 1, sizeof(oHeader), pFile) != sizeof(oHeader))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        if (fclose(pFile))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        return nRet;
+    }
+
+    // 򿪹鵵ļ
+    int Open(const std::string& strArchive)
+    {
+        Close();
+        if (m_oFile.Open(strArchive, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        unsigned long long nFileSize = 0;
+        long long nMTime = 0;
+        TDbfArchiveHeader& oHeader = m_oHeader;
+        if (m_oFile.Stat(nFileSize, nMTime) || m_oFile.ReadAt(0, &oHeader, sizeof(oHeader)) != sizeof(oHeader)
+            || memcmp(oHeader.szMagic, "PDBA", 4) || oHeader.nVersion != 1 || oHeader.nBlockRecs == 0 || oHeader.nRecLen == 0
+            || oHeader.nDbfHeaderLen < sizeof(TDbfHeader) + 1
+            || oHeader.nBlockNum != (oHeader.nRecNum + oHeader.nBlockRecs - 1) / oHeader.nBlockRecs
+            || oHeader.nIndexOffset + (unsigned long long)oHeader.nBlockNum * sizeof(TDbfArchiveBlock) > nFileSize)
+        {
+            Close();
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_vecHead.resize(oHeader.nDbfHeaderLen);
+        m_vecBlock.resize(oHeader.nBlockNum);
+        size_t nIndexSize = m_vecBlock.size() * sizeof(TDbfArchiveBlock);
+        std::map<std::string, size_t> mapField;
+        const TDbfHeader* pDbfHeader = (const TDbfHeader*)&m_vecHead[0];
+        if (m_oFile.ReadAt(sizeof(oHeader), &m_vecHead[0], m_vecHead.size()) != m_vecHead.size()
+            || (nIndexSize && m_oFile.ReadAt(oHeader.nIndexOffset, &m_vecBlock[0], nIndexSize) != nIndexSize)
+            || pDbfHeader->nHeaderLen > m_vecHead.size() || pDbfHeader->nHeaderLen <= sizeof(TDbfHeader)
+            || pDbfHeader->nRecLen != oHeader.nRecLen
+            || CPDbf::ParseField(&m_vecHead[sizeof(TDbfHeader)], pDbfHeader->nHeaderLen - sizeof(TDbfHeader), m_vecField, mapField))
+        {
+            Close();
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        for (size_t i = 0; i < m_vecBlock.size(); i++)
+        {
+            const TDbfArchiveBlock& oBlock = m_vecBlock[i];
+            if (oBlock.nRawSize != BlockRecNum(i) * oHeader.nRecLen || oBlock.nSize > oBlock.nRawSize
+                || oBlock.nOffset + oBlock.nSize > oHeader.nIndexOffset)
+            {
+                Close();
+                return CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        m_vecSeg = MakeSegment(m_vecField, oHeader.nRecLen);
+        return CIDbf::DBF_SUCC;
+    }
+
+    void Close()
+    {
+        m_oFile.Close();
+        m_oHeader = TDbfArchiveHeader();
+        m_vecHead.clear();
+        m_vecField.clear();
+        m_vecBlock.clear();
+        m_vecSeg.clear();
+        m_vecData.clear();
+        m_nRecNo = 0;
+        m_nRecNum = 0;
+        m_nCacheBlock = (size_t)-1;
+        m_vecCache.clear();
+    }
+
+    inline bool IsOpen() { return m_oFile.IsOpen(); }
+    inline size_t GetRecNum() const { return (size_t)m_oHeader.nRecNum; }
+    inline size_t GetRecLen() const { return m_oHeader.nRecLen; }
+    inline size_t GetBlockNum() const { return m_vecBlock.size(); }
+    const TDbfHeader& GetHeader() const { return *(const TDbfHeader*)&m_vecHead[0]; }
+    std::vector<TDbfField> GetField() const { return m_vecField; }
+
+    // ȡ[nRecNo, nRecNo + nRecNum)ļ¼ֻѹ漰Ŀ
+    int Read(size_t nRecNo, size_t nRecNum)
+    {
+        if (!IsOpen() || nRecNo > GetRecNum() || nRecNum > GetRecNum() - nRecNo)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        m_nRecNo = nRecNo;
+        m_nRecNum = nRecNum;
+        m_vecData.resize(nRecNum * GetRecLen());
+        if (nRecNum == 0)
+        {
+            return CIDbf::DBF_SUCC;
+        }
+        size_t nFirst = nRecNo / m_oHeader.nBlockRecs;
+        size_t nLast = (nRecNo + nRecNum - 1) / m_oHeader.nBlockRecs;
+        // ȡʱѹ˳Сȡظѹ
+        if (nFirst == nLast)
+        {
+            if (m_nCacheBlock != nFirst)
+            {
+                std::vector<char> vecComp(m_vecBlock[nFirst].nSize);
+                if (ReadBlock(nFirst, nFirst, vecComp) || !DecodeBlock(&vecComp[0], m_vecBlock[nFirst], m_vecCache))
+                {
+                    m_nCacheBlock = (size_t)-1;
+                    return CIDbf::DBF_FILE_ERROR;
+                }
+                m_nCacheBlock = nFirst;
+            }
+            Unshuffle(&m_vecCache[0], BlockRecNum(nFirst), nRecNo - nFirst * m_oHeader.nBlockRecs, nRecNum, &m_vecData[0]);
+            return CIDbf::DBF_SUCC;
+        }
+        // 漰Ŀļһζнѹ
+        std::vector<char> vecComp;
+        if (ReadBlock(nFirst, nLast, vecComp))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nThreadNum = MMin(MMax(m_nThreadNum, (size_t)1), nLast - nFirst + 1);
+        std::vector<int> vecRet(nThreadNum, CIDbf::DBF_SUCC);
+        std::vector<std::thread> vecThread;
+        for (size_t t = 1; t < nThreadNum; t++)
+        {
+            vecThread.push_back(std::thread(&CDbfArchive::DecodeRange, this, &vecComp[0], nFirst, nLast, t, nThreadNum, std::ref(vecRet[t])));
+        }
+        DecodeRange(&vecComp[0], nFirst, nLast, 0, nThreadNum, vecRet[0]);
+        int nRet = CIDbf::DBF_SUCC;
+        for (size_t t = 0; t < nThreadNum; t++)
+        {
+            if (t > 0)
+            {
+                vecThread[t - 1].join();
+            }
+            nRet = nRet ? nRet : vecRet[t];
+        }
+        return nRet;
+    }
+
+    // һReadеĵnRec¼
+    inline const char* ReadData(size_t nRec = 0) const
+    {
+        assert(nRec < m_nRecNum);
+        return &m_vecData[nRec * GetRecLen()];
+    }
+    inline size_t GetReadNum() const { return m_nRecNum; }
+
+    // ԭΪDBFļӳ񣬿CPDbf::OpenInMemory
+    int Extract(std::vector<char>& vecImage)
+    {
+        if (!IsOpen())
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        vecImage.clear();
+        vecImage.reserve(m_vecHead.size() + GetRecNum() * GetRecLen() + 1);
+        vecImage.insert(vecImage.end(), m_vecHead.begin(), m_vecHead.end());
+        size_t nStep = (size_t)m_oHeader.nBlockRecs * MMax(m_nThreadNum, (size_t)1);
+        for (size_t nRecNo = 0; nRecNo < GetRecNum(); nRecNo += nStep)
+        {
+            if (Read(nRecNo, MMin(nStep, GetRecNum() - nRecNo)))
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            vecImage.insert(vecImage.end(), m_vecData.begin(), m_vecData.end());
+        }
+        vecImage.push_back(0x1A);
+        return CIDbf::DBF_SUCC;
+    }
+    // ԭΪDBFļ
+    int Extract(const std::string& strDbf)
+    {
+        std::vector<char> vecImage;
+        if (Extract(vecImage))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        CDbfMemFile oFile;
+        oFile.Open(vecImage);
+        return oFile.Save(strDbf) ? CIDbf::DBF_FILE_ERROR : CIDbf::DBF_SUCC;
+    }
+
+public:
+    // ѹȡ߳
+    size_t m_nThreadNum;
+    // ѹʱÿļ¼
+    size_t m_nBlockRecs;
+
+private:
+    CDbfArchive(const CDbfArchive&);
+    CDbfArchive& operator=(const CDbfArchive&);
+
+    // ¼һֽڣӦһֶ
+    struct TSegment
+    {
+        size_t nPos;
+        size_t nLen;
+    };
+    // ֶλּ¼ֶβǡø¼ʱΪһ
+    static std::vector<TSegment> MakeSegment(const std::vector<TDbfField>& vecField, size_t nRecLen)
+    {
+        std::vector<TSegment> vecSeg;
+        TSegment oSeg;
+        oSeg.nPos = 0;
+        oSeg.nLen = 1;
+        vecSeg.push_back(oSeg);
+        for (size_t i = 0; i < vecField.size(); i++)
+        {
+            oSeg.nPos = vecField[i].nPosition;
+            oSeg.nLen = vecField[i].cLength;
+            if (oSeg.nPos != vecSeg.back().nPos + vecSeg.back().nLen || oSeg.nLen == 0)
+            {
+                break;
+            }
+            vecSeg.push_back(oSeg);
+        }
+        if (vecSeg.back().nPos + vecSeg.back().nLen != nRecLen || vecSeg.size() != vecField.size() + 1)
+        {
+            vecSeg.resize(1);
+            vecSeg[0].nLen = nRecLen;
+        }
+        return vecSeg;
+    }
+
+    static void CompressBlock(const char* pData, size_t nRecNum, size_t nRecLen, const std::vector<TSegment>& vecSeg, std::vector<char>& vecOut)
+    {
+        size_t nRawSize = nRecNum * nRecLen;
+        std::vector<char> vecCol(nRawSize);
+        char* pCol = &vecCol[0];
+        for (size_t s = 0; s < vecSeg.size(); s++)
+        {
+            const char* pField = pData + vecSeg[s].nPos;
+            for (size_t i = 0; i < nRecNum; i++, pField += nRecLen, pCol += vecSeg[s].nLen)
+            {
+                memcpy(pCol, pField, vecSeg[s].nLen);
+            }
+        }
+        vecOut.resize(CDbfLz::Bound(nRawSize));
+        size_t nSize = CDbfLz::Compress(&vecCol[0], nRawSize, &vecOut[0], nRawSize - 1);
+        if (nSize == 0)
+        {
+            // ѹʱԭ
+            vecOut.swap(vecCol);
+        }
+        else
+        {
+            vecOut.resize(nSize);
+        }
+    }
+    static bool DecodeBlock(const char* pComp, const TDbfArchiveBlock& oBlock, std::vector<char>& vecCol)
+    {
+        vecCol.resize(oBlock.nRawSize);
+        if (oBlock.nSize == oBlock.nRawSize)
+        {
+            memcpy(&vecCol[0], pComp, oBlock.nRawSize);
+            return true;
+        }
+        return CDbfLz::Decompress(pComp, oBlock.nSize, &vecCol[0], oBlock.nRawSize);
+    }
+    // ӰдŵĿȡ[nStart, nStart + nNum)ļ¼
+    void Unshuffle(const char* pCol, size_t nBlockRecNum, size_t nStart, size_t nNum, char* pOut) const
+    {
+        size_t nRecLen = GetRecLen();
+        for (size_t s = 0; s < m_vecSeg.size(); s++)
+        {
+            size_t nLen = m_vecSeg[s].nLen;
+            const char* pSrc = pCol + nStart * nLen;
+            char* pDst = pOut + m_vecSeg[s].nPos;
+            for (size_t i = 0; i < nNum; i++, pSrc += nLen, pDst += nRecLen)
+            {
+                memcpy(pDst, pSrc, nLen);
+            }
+            pCol += nBlockRecNum * nLen;
+        }
+    }
+    // ѹ[nFirst, nLast]ɵt̸߳Ŀ
+    void DecodeRange(const char* pComp, size_t nFirst, size_t nLast, size_t t, size_t nThreadNum, int& nRet)
+    {
+        std::vector<char> vecCol;
+        for (size_t b = nFirst + t; b <= nLast; b += nThreadNum)
+        {
+            const TDbfArchiveBlock& oBlock = m_vecBlock[b];
+            if (!DecodeBlock(pComp + (oBlock.nOffset - m_vecBlock[nFirst].nOffset), oBlock, vecCol))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+                return;
+            }
+            size_t nBlockStart = b * m_oHeader.nBlockRecs;
+            size_t nStart = MMax(nBlockStart, m_nRecNo);
+            size_t nEnd = MMin(nBlockStart + BlockRecNum(b), m_nRecNo + m_nRecNum);
+            Unshuffle(&vecCol[0], BlockRecNum(b), nStart - nBlockStart, nEnd - nStart, &m_vecData[(nStart - m_nRecNo) * GetRecLen()]);
+        }
+    }
+    // [nFirst, nLast]ѹ
+    int ReadBlock(size_t nFirst, size_t nLast, std::vector<char>& vecComp)
+    {
+        unsigned long long nOffset = m_vecBlock[nFirst].nOffset;
+        size_t nSize = (size_t)(m_vecBlock[nLast].nOffset + m_vecBlock[nLast].nSize - nOffset);
+        vecComp.resize(MMax(nSize, (size_t)1));
+        return m_oFile.ReadAt(nOffset, &vecComp[0], nSize) == nSize ? CIDbf::DBF_SUCC : CIDbf::DBF_FILE_ERROR;
+    }
+    inline size_t BlockRecNum(size_t nBlock) const
+    {
+        return (size_t)MMin((unsigned long long)m_oHeader.nBlockRecs, m_oHeader.nRecNum - (unsigned long long)nBlock * m_oHeader.nBlockRecs);
+    }
+
+    // ȡDBFļͷֶμע
+    static int ReadDbfHead(const std::string& strDbf, std::vector<char>& vecHead)
+    {
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strDbf.c_str(), "rb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        TDbfHeader oHeader;
+        int nRet = CIDbf::DBF_FILE_ERROR;
+        if (fread(&oHeader, 1, sizeof(oHeader), pFile) == sizeof(oHeader) && oHeader.nHeaderLen > sizeof(oHeader))
+        {
+            vecHead.resize(oHeader.nHeaderLen + CPDbf::GetRemarkSize(oHeader.cVer));
+            memcpy(&vecHead[0], &oHeader, sizeof(oHeader));
+            size_t nLeft = vecHead.size() - sizeof(oHeader);
+            if (fread(&vecHead[sizeof(oHeader)], 1, nLeft, pFile) == nLeft)
+            {
+                nRet = CIDbf::DBF_SUCC;
+            }
+        }
+        fclose(pFile);
+        return nRet;
+    }
+
+private:
+    CDbfFile m_oFile;
+    TDbfArchiveHeader m_oHeader;
+    // DBFļͷԭ
+    std::vector<char> m_vecHead;
+    std::vector<TDbfField> m_vecField;
+    std::vector<TDbfArchiveBlock> m_vecBlock;
+    std::vector<TSegment> m_vecSeg;
+    // һζȡļ¼
+    std::vector<char> m_vecData;
+    size_t m_nRecNo;
+    size_t m_nRecNum;
+    // һεȡѹĿ
+    size_t m_nCacheBlock;
+    std::vector<char> m_vecCache;
+};
+
+#endif
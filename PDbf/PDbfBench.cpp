@@ -0,0 +1,544 @@
+﻿// PDbfBench.cpp : PDbf性能测试，生成测试文件后依次测试写入、批量读取、直接读取、字段解析、存储方式及文件比较，
+// 结果以JSON输出，便于不同版本之间对比
+// 编译：g++ -std=c++11 -O2 -pthread PDbfBench.cpp -o PDbfBench
+// 用法：PDbfBench [--rows N] [--cols N] [--width N] [--schema C10,N12,N15.3,D8] [--file 路径] [--out 结果文件] [--keep]
+//
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PDbf.h"
+
+using namespace std;
+
+// 计时
+class CBenchTimer
+{
+public:
+    CBenchTimer() { Reset(); }
+    void Reset() { m_tStart = chrono::steady_clock::now(); }
+    // 自Reset以来的纳秒数
+    long long Elapsed() const
+    {
+        return (long long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - m_tStart).count();
+    }
+
+private:
+    chrono::steady_clock::time_point m_tStart;
+};
+
+// 一项测试结果
+class TBenchResult
+{
+public:
+    string strName;                 // 测试名
+    string strParam;                // 参数，JSON对象内容
+    size_t nRows;                   // 处理的记录数
+    double fBytes;                  // 处理的字节数
+    long long nTotalNs;             // 总耗时
+    vector<long long> vecBatchNs;   // 每批耗时
+
+    TBenchResult(const string& strName_, const string& strParam_ = "")
+        : strName(strName_), strParam(strParam_), nRows(0), fBytes(0), nTotalNs(0)
+    {
+    }
+
+    // 每批耗时的百分位，微秒
+    double Percentile(double fRate) const
+    {
+        if (vecBatchNs.empty())
+        {
+            return 0;
+        }
+        vector<long long> vecNs(vecBatchNs);
+        size_t nPos = MMin((size_t)(fRate * vecNs.size()), vecNs.size() - 1);
+        nth_element(vecNs.begin(), vecNs.begin() + nPos, vecNs.end());
+        return vecNs[nPos] / 1000.0;
+    }
+
+    string ToJson() const
+    {
+        double fSec = nTotalNs / 1e9;
+        char szBuf[512];
+        snprintf(szBuf, sizeof(szBuf),
+            "{\"name\":\"%s\",\"params\":{%s},\"rows\":%zu,\"bytes\":%.0f,\"seconds\":%.6f,\"rows_per_sec\":%.1f,"
+            "\"mb_per_sec\":%.2f,\"batches\":%zu,\"p50_us\":%.2f,\"p99_us\":%.2f}",
+            strName.c_str(), strParam.c_str(), nRows, fBytes, fSec, fSec > 0 ? nRows / fSec : 0.0,
+            fSec > 0 ? fBytes / fSec / 1048576.0 : 0.0, vecBatchNs.size(), Percentile(0.5), Percentile(0.99));
+        return szBuf;
+    }
+};
+
+// 测试配置
+class TBenchConfig
+{
+public:
+    size_t nRows;
+    size_t nCols;
+    size_t nWidth;
+    string strSchema;
+    string strFile;
+    string strOut;
+    bool bKeep;
+    // 逐条或小批量读取的最大记录数，避免小批量测试耗时过长
+    size_t nSmallRows;
+
+    TBenchConfig()
+    {
+        nRows = 1000000;
+        nCols = 16;
+        nWidth = 10;
+        strFile = "bench.dbf";
+        bKeep = false;
+        nSmallRows = 200000;
+    }
+};
+
+// 解析字段定义，如"C10,N12,N15.3,D8"；未指定时按C/N/N带小数/D循环生成nCols个字段
+static bool MakeFields(const TBenchConfig& oConfig, vector<TDbfField>& vecField)
+{
+    vector<string> vecSpec;
+    if (oConfig.strSchema.empty())
+    {
+        const char* arrSpec[] = { "C", "N12", "N15.3", "D8" };
+        for (size_t i = 0; i < oConfig.nCols; i++)
+        {
+            string strSpec = arrSpec[i % 4];
+            vecSpec.push_back(strSpec == "C" ? strSpec + to_string(oConfig.nWidth) : strSpec);
+        }
+    }
+    else
+    {
+        size_t nStart = 0;
+        while (nStart <= oConfig.strSchema.size())
+        {
+            size_t nEnd = oConfig.strSchema.find(',', nStart);
+            nEnd = nEnd == string::npos ? oConfig.strSchema.size() : nEnd;
+            vecSpec.push_back(oConfig.strSchema.substr(nStart, nEnd - nStart));
+            nStart = nEnd + 1;
+        }
+    }
+    for (size_t i = 0; i < vecSpec.size(); i++)
+    {
+        TDbfField oField;
+        memset(&oField, 0, sizeof(oField));
+        int nLen = 0;
+        int nPrec = 0;
+        if (vecSpec[i].size() < 2 || sscanf(vecSpec[i].c_str() + 1, "%d.%d", &nLen, &nPrec) < 1 || nLen <= 0 || nLen > 254
+            || nPrec < 0 || nPrec >= nLen || !strchr("CNFDL", vecSpec[i][0]))
+        {
+            printf("字段定义错误: %s\n", vecSpec[i].c_str());
+            return false;
+        }
+        snprintf(oField.szName, sizeof(oField.szName), "F%u", (unsigned int)(i + 1) % 100000000U);
+        oField.cType = vecSpec[i][0];
+        oField.cLength = (unsigned char)nLen;
+        oField.cPrecisionLength = (unsigned char)nPrec;
+        vecField.push_back(oField);
+    }
+    return !vecField.empty();
+}
+
+// 生成第nRow条记录第nCol个字段的值
+static void MakeValue(const TDbfField& oField, size_t nRow, size_t nCol, string& strValue)
+{
+    char szBuf[256];
+    unsigned long long nRand = (nRow + 1) * 2654435761ULL ^ (nCol + 1) * 40503ULL;
+    switch (oField.cType)
+    {
+    case 'N':
+    case 'F':
+        if (oField.cPrecisionLength)
+        {
+            snprintf(szBuf, sizeof(szBuf), "%.*f", (int)oField.cPrecisionLength, (nRand % 10000000) / 100.0);
+        }
+        else
+        {
+            snprintf(szBuf, sizeof(szBuf), "%llu", nRand % 100000000ULL);
+        }
+        break;
+    case 'D':
+        snprintf(szBuf, sizeof(szBuf), "20%02llu%02llu%02llu", nRand % 30, nRand % 12 + 1, nRand % 28 + 1);
+        break;
+    case 'L':
+        snprintf(szBuf, sizeof(szBuf), "%c", nRand & 1 ? 'T' : 'F');
+        break;
+    default:
+        snprintf(szBuf, sizeof(szBuf), "V%llu", nRand % 1000000ULL);
+        break;
+    }
+    strValue.assign(szBuf, MMin(strlen(szBuf), (size_t)oField.cLength));
+}
+
+// 写入：每批PrepareAppend、逐字段写入、WriteCommit
+static bool BenchWrite(const TBenchConfig& oConfig, const vector<TDbfField>& vecField, vector<TBenchResult>& vecResult)
+{
+    const size_t nBatch = 4096;
+    TBenchResult oResult("write_commit", "\"batch\":" + to_string(nBatch));
+    CPDbf oDbf;
+    if (oDbf.Create(oConfig.strFile, vecField))
+    {
+        printf("创建DBF文件失败: %s\n", oConfig.strFile.c_str());
+        return false;
+    }
+    // 预先生成每个字段的一组取值，写入时循环使用，计时不包含取值生成
+    const size_t nValueNum = 1024;
+    vector<vector<string> > vecValue(vecField.size(), vector<string>(nValueNum));
+    for (size_t j = 0; j < vecField.size(); j++)
+    {
+        for (size_t k = 0; k < nValueNum; k++)
+        {
+            MakeValue(vecField[j], k * 7919 + j, j, vecValue[j][k]);
+        }
+    }
+    CBenchTimer oTotal;
+    for (size_t nRow = 0; nRow < oConfig.nRows; nRow += nBatch)
+    {
+        CBenchTimer oTimer;
+        size_t nNum = MMin(nBatch, oConfig.nRows - nRow);
+        if (oDbf.PrepareAppend(nNum))
+        {
+            printf("申请预写入数据失败\n");
+            return false;
+        }
+        for (size_t i = 0; i < nNum; i++)
+        {
+            oDbf.WriteGo(i);
+            for (size_t j = 0; j < vecField.size(); j++)
+            {
+                oDbf.WriteString(j, vecValue[j][(nRow + i) % nValueNum]);
+            }
+        }
+        if (oDbf.WriteCommit())
+        {
+            printf("写入数据提交失败\n");
+            return false;
+        }
+        oResult.vecBatchNs.push_back(oTimer.Elapsed());
+    }
+    oDbf.FileCommit();
+    oResult.nTotalNs = oTotal.Elapsed();
+    oResult.nRows = oConfig.nRows;
+    oResult.fBytes = (double)oConfig.nRows * oDbf.GetRecLen();
+    oDbf.Close();
+    vecResult.push_back(oResult);
+    return true;
+}
+
+// 按批读取整个文件，nMaxRows为0时读取全部记录；bParse为true时逐字段按类型解析
+template<class TDbf>
+static bool BenchRead(TDbf& oDbf, const string& strName, const string& strParam, size_t nBatch, size_t nMaxRows, bool bParse,
+    vector<TBenchResult>& vecResult)
+{
+    TBenchResult oResult(strName, strParam);
+    size_t nRows = nMaxRows ? MMin(nMaxRows, oDbf.GetRecNum()) : oDbf.GetRecNum();
+    vector<TDbfField> vecField = oDbf.GetField();
+    double fSum = 0;
+    string strValue;
+    CBenchTimer oTotal;
+    for (size_t nRow = 0; nRow < nRows; nRow += nBatch)
+    {
+        CBenchTimer oTimer;
+        size_t nNum = MMin(nBatch, nRows - nRow);
+        if (oDbf.Read(nRow, nNum))
+        {
+            printf("读取DBF文件缓存行失败\n");
+            return false;
+        }
+        if (bParse)
+        {
+            for (size_t i = 0; i < nNum; i++)
+            {
+                oDbf.ReadGo(i);
+                for (size_t j = 0; j < vecField.size(); j++)
+                {
+                    double fValue = 0;
+                    if (vecField[j].cType == 'N' || vecField[j].cType == 'F')
+                    {
+                        oDbf.ReadDouble(j, fValue);
+                    }
+                    else
+                    {
+                        oDbf.ReadString(j, strValue);
+                        fValue = (double)strValue.size();
+                    }
+                    fSum += fValue;
+                }
+            }
+        }
+        else
+        {
+            fSum += oDbf.ReadData(nNum - 1)[0];
+        }
+        oResult.vecBatchNs.push_back(oTimer.Elapsed());
+    }
+    oResult.nTotalNs = oTotal.Elapsed();
+    oResult.nRows = nRows;
+    oResult.fBytes = (double)nRows * oDbf.GetRecLen();
+    vecResult.push_back(oResult);
+    // 防止解析结果被优化掉
+    if (fSum == -1)
+    {
+        printf("%f\n", fSum);
+    }
+    return true;
+}
+
+// 批量大小扫描
+static bool BenchReadSweep(const TBenchConfig& oConfig, vector<TBenchResult>& vecResult)
+{
+    const size_t arrBatch[] = { 1, 16, 256, 4096, 65536 };
+    for (size_t i = 0; i < sizeof(arrBatch) / sizeof(arrBatch[0]); i++)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(oConfig.strFile))
+        {
+            return false;
+        }
+        size_t nMaxRows = arrBatch[i] < 256 ? oConfig.nSmallRows : 0;
+        if (!BenchRead(oDbf, "read_batch", "\"batch\":" + to_string(arrBatch[i]), arrBatch[i], nMaxRows, false, vecResult))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 直接读取：不经过读缓存，每条记录每个字段从文件读取，与按批缓存读取对比
+static bool BenchReadDirect(const TBenchConfig& oConfig, vector<TBenchResult>& vecResult)
+{
+    CPDbf oDbf;
+    if (oDbf.Open(oConfig.strFile))
+    {
+        return false;
+    }
+    size_t nRows = MMin(oConfig.nSmallRows, oDbf.GetRecNum());
+    if (!BenchRead(oDbf, "read_cached", "\"batch\":4096", 4096, nRows, true, vecResult))
+    {
+        return false;
+    }
+    TBenchResult oResult("read_direct");
+    size_t nFieldNum = oDbf.GetFieldNum();
+    string strValue;
+    CBenchTimer oTotal;
+    for (size_t nRow = 0; nRow < nRows; nRow++)
+    {
+        CBenchTimer oTimer;
+        for (size_t j = 0; j < nFieldNum; j++)
+        {
+            if (oDbf.ReadField(nRow, j, strValue))
+            {
+                printf("直接读取字段失败\n");
+                return false;
+            }
+        }
+        oResult.vecBatchNs.push_back(oTimer.Elapsed());
+    }
+    oResult.nTotalNs = oTotal.Elapsed();
+    oResult.nRows = nRows;
+    oResult.fBytes = (double)nRows * oDbf.GetRecLen();
+    vecResult.push_back(oResult);
+    return true;
+}
+
+// 字段解析：默认解析与快速解析
+static bool BenchParse(const TBenchConfig& oConfig, vector<TBenchResult>& vecResult)
+{
+    CPDbf oDefault;
+    BasicDbf<CDbfFile, CDbfFastParse> oFast;
+    if (oDefault.Open(oConfig.strFile) || oFast.Open(oConfig.strFile))
+    {
+        return false;
+    }
+    return BenchRead(oDefault, "parse", "\"parser\":\"default\"", 4096, 0, true, vecResult)
+        && BenchRead(oFast, "parse", "\"parser\":\"fast\"", 4096, 0, true, vecResult);
+}
+
+// 存储方式：stdio、pread、mmap及内存模式
+static bool BenchStorage(const TBenchConfig& oConfig, vector<TBenchResult>& vecResult)
+{
+    BasicDbf<CDbfStdioFile> oStdio;
+    BasicDbf<CDbfPreadFile> oPread;
+    BasicDbf<CDbfMmapFile> oMmap;
+    CPDbf oMem;
+    if (oStdio.Open(oConfig.strFile) || oPread.Open(oConfig.strFile) || oMmap.Open(oConfig.strFile))
+    {
+        return false;
+    }
+    if (!BenchRead(oStdio, "storage", "\"storage\":\"stdio\"", 4096, 0, false, vecResult)
+        || !BenchRead(oPread, "storage", "\"storage\":\"pread\"", 4096, 0, false, vecResult)
+        || !BenchRead(oMmap, "storage", "\"storage\":\"mmap\"", 4096, 0, false, vecResult))
+    {
+        return false;
+    }
+    // 内存模式包含整体读入文件的时间
+    CBenchTimer oTimer;
+    if (oMem.OpenInMemory(oConfig.strFile))
+    {
+        return false;
+    }
+    long long nLoadNs = oTimer.Elapsed();
+    if (!BenchRead(oMem, "storage", "\"storage\":\"memory\"", 4096, 0, false, vecResult))
+    {
+        return false;
+    }
+    vecResult.back().nTotalNs += nLoadNs;
+    return true;
+}
+
+// 文件比较：与完全相同的副本比较，需遍历全部记录
+static bool BenchCmp(const TBenchConfig& oConfig, vector<TBenchResult>& vecResult)
+{
+    string strCopy = oConfig.strFile + ".cmp";
+    {
+        ifstream oIn(oConfig.strFile.c_str(), ios::binary);
+        ofstream oOut(strCopy.c_str(), ios::binary);
+        oOut << oIn.rdbuf();
+        if (!oOut)
+        {
+            return false;
+        }
+    }
+    CPDbf oDbf;
+    if (oDbf.Open(oConfig.strFile))
+    {
+        remove(strCopy.c_str());
+        return false;
+    }
+    vector<TDbfField> vecField = oDbf.GetField();
+    const bool arrRaw[] = { true, false };
+    for (size_t i = 0; i < 2; i++)
+    {
+        // 比较全部字段
+        CCMPDbf oCmp;
+        oCmp.m_bRawCmp = arrRaw[i];
+        for (size_t j = 0; j < vecField.size(); j++)
+        {
+            oCmp.m_vecField.push_back(vecField[j].szName);
+        }
+        TBenchResult oResult("cmp", string("\"raw\":") + (arrRaw[i] ? "true" : "false"));
+        CBenchTimer oTimer;
+        bool bSame = oCmp.Cmp(oConfig.strFile, strCopy);
+        oResult.nTotalNs = oTimer.Elapsed();
+        oResult.vecBatchNs.push_back(oResult.nTotalNs);
+        if (!bSame)
+        {
+            printf("比较结果错误\n");
+            remove(strCopy.c_str());
+            return false;
+        }
+        oResult.nRows = oDbf.GetRecNum();
+        oResult.fBytes = 2.0 * oDbf.GetRecNum() * oDbf.GetRecLen();
+        vecResult.push_back(oResult);
+    }
+    remove(strCopy.c_str());
+    return true;
+}
+
+static bool ParseArgs(int argc, char* argv[], TBenchConfig& oConfig)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string strArg = argv[i];
+        bool bHasValue = i + 1 < argc;
+        if (strArg == "--keep")
+        {
+            oConfig.bKeep = true;
+        }
+        else if (strArg == "--rows" && bHasValue)
+        {
+            oConfig.nRows = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strArg == "--cols" && bHasValue)
+        {
+            oConfig.nCols = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strArg == "--width" && bHasValue)
+        {
+            oConfig.nWidth = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strArg == "--schema" && bHasValue)
+        {
+            oConfig.strSchema = argv[++i];
+        }
+        else if (strArg == "--file" && bHasValue)
+        {
+            oConfig.strFile = argv[++i];
+        }
+        else if (strArg == "--out" && bHasValue)
+        {
+            oConfig.strOut = argv[++i];
+        }
+        else
+        {
+            printf("用法: %s [--rows N] [--cols N] [--width N] [--schema C10,N12,N15.3,D8] [--file 路径] [--out 结果文件] [--keep]\n", argv[0]);
+            return false;
+        }
+    }
+    // DBF文件头中记录数为32位
+    if (oConfig.nRows == 0 || oConfig.nRows > 0xFFFFFFFFULL || oConfig.nCols == 0 || oConfig.nWidth == 0 || oConfig.nWidth > 254)
+    {
+        printf("参数错误\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    TBenchConfig oConfig;
+    vector<TDbfField> vecField;
+    if (!ParseArgs(argc, argv, oConfig) || !MakeFields(oConfig, vecField))
+    {
+        return 1;
+    }
+
+    vector<TBenchResult> vecResult;
+    bool bOk = BenchWrite(oConfig, vecField, vecResult)
+        && BenchReadSweep(oConfig, vecResult)
+        && BenchReadDirect(oConfig, vecResult)
+        && BenchParse(oConfig, vecResult)
+        && BenchStorage(oConfig, vecResult)
+        && BenchCmp(oConfig, vecResult);
+    if (!oConfig.bKeep)
+    {
+        remove(oConfig.strFile.c_str());
+    }
+    if (!bOk)
+    {
+        printf("测试失败\n");
+        return 1;
+    }
+
+    // 输出JSON
+    size_t nRecLen = 1;
+    for (size_t i = 0; i < vecField.size(); i++)
+    {
+        nRecLen += vecField[i].cLength;
+    }
+    string strJson = "{\"version\":1,\"config\":{\"rows\":" + to_string(oConfig.nRows) + ",\"fields\":" + to_string(vecField.size())
+        + ",\"rec_len\":" + to_string(nRecLen) + "},\"results\":[\n";
+    for (size_t i = 0; i < vecResult.size(); i++)
+    {
+        strJson += "  " + vecResult[i].ToJson() + (i + 1 < vecResult.size() ? ",\n" : "\n");
+    }
+    strJson += "]}\n";
+    if (oConfig.strOut.empty())
+    {
+        fputs(strJson.c_str(), stdout);
+    }
+    else
+    {
+        ofstream oOut(oConfig.strOut.c_str(), ios::binary);
+        oOut << strJson;
+        if (!oOut)
+        {
+            printf("写入结果文件失败: %s\n", oConfig.strOut.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_CDC_H__
+#define __P_DBF_CDC_H__
+#include <iterator>
+#include <unordered_map>
+#include "PDbf.h"
+#include "../HighlyConcurrent/concurrentqueue/concurrentqueue.h"
+
+// ¼
+enum EDbfChange
+{
+    DBF_CHANGE_INSERT,  // ¼
+    DBF_CHANGE_UPDATE,  // ޸ļ¼
+    DBF_CHANGE_DELETE,  // ɾ¼
+};
+
+// ¼¼
+class TDbfChange
+{
+public:
+    // 
+    int nType;
+    // ¼ţɾʱΪļеļ¼
+    size_t nRecNo;
+    // ¼δüֶʱΪգԼ¼Ϊ
+    std::string strKey;
+    // ֶ룬kλӦkֶΣɾʱΪ
+    std::vector<unsigned long long> vecMask;
+    // ¼¼ԭʼݣɾʱΪɼ¼
+    std::string strRecord;
+
+    TDbfChange()
+    {
+        nType = DBF_CHANGE_INSERT;
+        nRecNo = 0;
+    }
+
+    // жֶǷ仯ɾʱֶξΪ仯
+    bool IsChanged(size_t nCol) const
+    {
+        if (nType != DBF_CHANGE_UPDATE)
+        {
+            return true;
+        }
+        size_t nWord = nCol / 64;
+        return nWord < vecMask.size() && (vecMask[nWord] >> (nCol % 64)) & 1;
+    }
+};
+
+// DBF
+// һεļ¼գÿRefresh¶ȡļ޸ġɾļ¼¼ʽ
+// дУ̴߳GetQueue()ȡ¼Ҫɨ
+// ֻһ̵߳Refreshп߳
+class CDbfCdc
+{
+public:
+    typedef moodycamel::ConcurrentQueue<TDbfChange> TQueue;
+
+    CDbfCdc()
+        : m_oToken(m_oQueue)
+    {
+        m_nReadNum = 10000;
+        m_nBlockRecs = 256;
+        m_nRecLen = 0;
+        m_nRecNum = 0;
+    }
+public:
+    // ÿȡļ¼
+    size_t m_nReadNum;
+    // ٱȽϵĿ¼ͬʱбȽ
+    size_t m_nBlockRecs;
+
+    // ü¼ֶΣΪʱԼ¼ΪڵһRefreshǰ
+    void SetKey(const std::vector<std::string>& vecKey)
+    {
+        m_vecKeyName = vecKey;
+    }
+
+    // ¶ȡļɱ¼ɵ¼
+    // һεʱм¼Ϊ¼ֶβֱ仯ʱؽղȫΪ
+    int Refresh(CPDbf& oDbf, size_t* pChanges = NULL)
+    {
+        if (!oDbf.IsOpen())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        // ȡ¿
+        size_t nRecLen = oDbf.GetRecLen();
+        size_t nRecNum = oDbf.GetRecNum();
+        std::vector<char> vecData(nRecNum * nRecLen);
+        size_t nReadNum = MMax(m_nReadNum, (size_t)1);
+        for (size_t i = 0; i < nRecNum; i += nReadNum)
+        {
+            size_t nNum = MMin(nReadNum, nRecNum - i);
+            if (oDbf.Read(i, nNum))
+            {
+                return CIDbf::DBF_ERROR;
+            }
+            memcpy(&vecData[i * nRecLen], oDbf.ReadData(), nNum * nRecLen);
+        }
+
+        // ֱ仯վɿ
+        std::vector<TDbfField> vecField = oDbf.GetField();
+        if (nRecLen != m_nRecLen || !SameField(vecField))
+        {
+            if (ResolveKey(vecField))
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            m_vecField = vecField;
+            m_nRecLen = nRecLen;
+            m_nRecNum = 0;
+            m_vecData.clear();
+            m_mapKey.clear();
+        }
+
+        std::vector<TDbfChange> vecChange;
+        std::unordered_map<std::string, size_t> mapKey;
+        if (m_vecKeyCol.empty())
+        {
+            DiffByPos(vecData, nRecNum, vecChange);
+        }
+        else
+        {
+            DiffByKey(vecData, nRecNum, mapKey, vecChange);
+        }
+
+        // 滻ղ¼
+        m_vecData.swap(vecData);
+        m_mapKey.swap(mapKey);
+        m_nRecNum = nRecNum;
+        if (!vecChange.empty())
+        {
+            m_oQueue.enqueue_bulk(m_oToken, std::make_move_iterator(vecChange.begin()), vecChange.size());
+        }
+        if (pChanges)
+        {
+            *pChanges = vecChange.size();
+        }
+        return CIDbf::DBF_SUCC;
+    }
+    int Refresh(const std::string& strFile, size_t* pChanges = NULL)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return Refresh(oDbf, pChanges);
+    }
+
+    // ¼
+    inline TQueue& GetQueue() { return m_oQueue; }
+    // ֶϢڽ¼еԭʼ¼
+    inline const std::vector<TDbfField>& GetField() const { return m_vecField; }
+
+    // ¼¼жȡֶΣδȥհ
+    bool ReadField(const TDbfChange& oChange, size_t nCol, std::string& strValue) const
+    {
+        if (nCol >= m_vecField.size() || oChange.strRecord.size() != m_nRecLen)
+        {
+            return false;
+        }
+        const TDbfField& oField = m_vecField[nCol];
+        strValue.assign(oChange.strRecord, oField.nPosition, oField.cLength);
+        return true;
+    }
+
+private:
+    // ¼űȽ
+    void DiffByPos(const std::vector<char>& vecData, size_t nRecNum, std::vector<TDbfChange>& vecChange)
+    {
+        size_t nCmpNum = MMin(nRecNum, m_nRecNum);
+        size_t nBlockRecs = MMax(m_nBlockRecs, (size_t)1);
+        for (size_t i = 0; i < nCmpNum; i += nBlockRecs)
+        {
+            size_t nNum = MMin(nBlockRecs, nCmpNum - i);
+            if (memcmp(&vecData[i * m_nRecLen], &m_vecData[i * m_nRecLen], nNum * m_nRecLen) == 0)
+            {
+                continue;
+            }
+            for (size_t j = i; j < i + nNum; j++)
+            {
+                Compare(j, &m_vecData[j * m_nRecLen], j, &vecData[j * m_nRecLen], std::string(), vecChange);
+            }
+        }
+        for (size_t i = nCmpNum; i < nRecNum; i++)
+        {
+            Compare(0, NULL, i, &vecData[i * m_nRecLen], std::string(), vecChange);
+        }
+        for (size_t i = nCmpNum; i < m_nRecNum; i++)
+        {
+            Compare(i, &m_vecData[i * m_nRecLen], 0, NULL, std::string(), vecChange);
+        }
+    }
+
+    // ¼Ƚϣͬһλüͬʱ
+    void DiffByKey(const std::vector<char>& vecData, size_t nRecNum,
+        std::unordered_map<std::string, size_t>& mapKey, std::vector<TDbfChange>& vecChange)
+    {
+        std::vector<char> vecMatch(m_nRecNum, 0);
+        size_t nBlockRecs = MMax(m_nBlockRecs, (size_t)1);
+        mapKey.reserve(nRecNum);
+        for (size_t i = 0; i < nRecNum; i += nBlockRecs)
+        {
+            size_t nNum = MMin(nBlockRecs, nRecNum - i);
+            // δ仯
+            bool bSame = i + nNum <= m_nRecNum
+                && memcmp(&vecData[i * m_nRecLen], &m_vecData[i * m_nRecLen], nNum * m_nRecLen) == 0;
+            for (size_t j = i; j < i + nNum; j++)
+            {
+                const char* pNew = &vecData[j * m_nRecLen];
+                std::string strKey = MakeKey(pNew);
+                mapKey[strKey] = j;
+                if (bSame)
+                {
+                    vecMatch[j] = 1;
+                    continue;
+                }
+                size_t nOld = m_nRecNum;
+                if (j < m_nRecNum && !vecMatch[j] && MakeKey(&m_vecData[j * m_nRecLen]) == strKey)
+                {
+                    nOld = j;
+                }
+                else
+                {
+                    std::unordered_map<std::string, size_t>::const_iterator e = m_mapKey.find(strKey);
+                    if (e != m_mapKey.end() && !vecMatch[e->second])
+                    {
+                        nOld = e->second;
+                    }
+                }
+                if (nOld < m_nRecNum)
+                {
+                    vecMatch[nOld] = 1;
+                    Compare(nOld, &m_vecData[nOld * m_nRecLen], j, pNew, strKey, vecChange);
+                }
+                else
+                {
+                    Compare(0, NULL, j, pNew, strKey, vecChange);
+                }
+            }
+        }
+        // δƥľɼ¼ѱɾ
+        for (size_t i = 0; i < m_nRecNum; i++)
+        {
+            if (!vecMatch[i])
+            {
+                const char* pOld = &m_vecData[i * m_nRecLen];
+                Compare(i, pOld, 0, NULL, MakeKey(pOld), vecChange);
+            }
+        }
+    }
+
+    // Ƚ¾ɼ¼¼¼ΪNULLɾ־ʱΪ
+    void Compare(size_t nOldNo, const char* pOld, size_t nNewNo, const char* pNew,
+        const std::string& strKey, std::vector<TDbfChange>& vecChange)
+    {
+        bool bOld = pOld && *pOld != '*';
+        bool bNew = pNew && *pNew != '*';
+        if (!bOld && !bNew)
+        {
+            return;
+        }
+        TDbfChange oChange;
+        oChange.strKey = strKey;
+        if (!bOld)
+        {
+            oChange.nType = DBF_CHANGE_INSERT;
+            oChange.nRecNo = nNewNo;
+            oChange.strRecord.assign(pNew, m_nRecLen);
+        }
+        else if (!bNew)
+        {
+            oChange.nType = DBF_CHANGE_DELETE;
+            oChange.nRecNo = nOldNo;
+            oChange.strRecord.assign(pOld, m_nRecLen);
+        }
+        else
+        {
+            if (memcmp(pOld, pNew, m_nRecLen) == 0)
+            {
+                return;
+            }
+            oChange.nType = DBF_CHANGE_UPDATE;
+            oChange.nRecNo = nNewNo;
+            oChange.vecMask.assign((m_vecField.size() + 63) / 64, 0);
+            for (size_t k = 0; k < m_vecField.size(); k++)
+            {
+                const TDbfField& oField = m_vecField[k];
+                if (memcmp(pOld + oField.nPosition, pNew + oField.nPosition, oField.cLength))
+                {
+                    oChange.vecMask[k / 64] |= 1ULL << (k % 64);
+                }
+            }
+            oChange.strRecord.assign(pNew, m_nRecLen);
+        }
+        vecChange.push_back(std::move(oChange));
+    }
+
+    // ƴӼֶԭʼ
+    std::string MakeKey(const char* pRec) const
+    {
+        std::string strKey;
+        for (size_t i = 0; i < m_vecKeyCol.size(); i++)
+        {
+            const TDbfField& oField = m_vecField[m_vecKeyCol[i]];
+            strKey.append(pRec + oField.nPosition, oField.cLength);
+        }
+        return strKey;
+    }
+
+    // ֶתΪֶ
+    int ResolveKey(const std::vector<TDbfField>& vecField)
+    {
+        m_vecKeyCol.clear();
+        for (size_t i = 0; i < m_vecKeyName.size(); i++)
+        {
+            size_t n = CPDbf::FindField(vecField, m_vecKeyName[i]);
+            if (n >= vecField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            m_vecKeyCol.push_back(n);
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // жֶβǷһ
+    bool SameField(const std::vector<TDbfField>& vecField) const
+    {
+        if (vecField.size() != m_vecField.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < vecField.size(); i++)
+        {
+            if (strncmp(vecField[i].szName, m_vecField[i].szName, sizeof(vecField[i].szName))
+                || vecField[i].cType != m_vecField[i].cType
+                || vecField[i].cLength != m_vecField[i].cLength)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // ¼
+    TQueue m_oQueue;
+    // 
+    moodycamel::ProducerToken m_oToken;
+    // ֶ
+    std::vector<std::string> m_vecKeyName;
+    // ֶ
+    std::vector<size_t> m_vecKeyCol;
+    // ֶϢ
+    std::vector<TDbfField> m_vecField;
+    // ռ¼
+    size_t m_nRecLen;
+    // ռ¼
+    size_t m_nRecNum;
+    // ռ¼
+    std::vector<char> m_vecData;
+    // ռ
+    std::unordered_map<std::string, size_t> m_mapKey;
+};
+
+#endif
@@ -0,0 +1,534 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_COLUMN_H__
+#define __P_DBF_COLUMN_H__
+#include "PDbf.h"
+#include "PDbfDigest.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+// ле
+enum EDbfColumnType
+{
+    DBF_COL_BYTES,      // ԭʼֽ
+    DBF_COL_DOUBLE,     // Сֵdouble
+    DBF_COL_INT64,      // long long
+};
+
+// лļͷ(64ֽ)
+class TDbfColumnHeader
+{
+public:
+    char szMagic[4];                // "PDCC"
+    unsigned int nVersion;          // 汾
+    unsigned long long nFileSize;   // DBFļС
+    long long nMTime;               // DBFļ޸ʱ()
+    unsigned long long nLayout;     // ֶζϣ
+    unsigned int nRecNum;           // ¼
+    unsigned int nColNum;           // 
+    unsigned short nHeaderLen;      // DBFļͷ
+    unsigned short nRecLen;         // DBF¼
+    char szReserved[20];
+
+    TDbfColumnHeader()
+    {
+        assert(sizeof(*this) == 64);
+        memset(this, 0, sizeof(*this));
+        memcpy(szMagic, "PDCC", 4);
+        nVersion = 2;
+    }
+};
+
+// Ŀ¼(32ֽ)
+class TDbfColumnEntry
+{
+public:
+    char szName[11];                // ֶ
+    char cType;                     // DBFֶ
+    unsigned char cLength;          // ֶγ
+    unsigned char cPrecision;       // Сλ
+    unsigned char cColType;         // ͣEDbfColumnType
+    char cReserved;
+    unsigned long long nOffset;     // ڻļеƫ
+    unsigned long long nSize;       // ݴС
+
+    TDbfColumnEntry()
+    {
+        assert(sizeof(*this) == 32);
+        memset(this, 0, sizeof(*this));
+    }
+};
+
+// ʽ
+// DBFļ.pdcļдѡֶΣֵֶνΪdoublelong longֶΪԭʼֽڣ
+// Ŀ¼֮ȴÿ¼ɾ־(ÿ1ֽ)ÿ64ֽڶ룬ʱӳ䵽ڴ档¼DBFļĴС޸ʱ䡢ļͷֶζ壬
+// һ仯ΪʧЧɨʱֻȡ⼸еݣٽ
+class CDbfColumnCache
+{
+public:
+    static const size_t npos = (size_t)-1;
+
+    CDbfColumnCache()
+    {
+        m_pData = NULL;
+        m_nSize = 0;
+        m_nBatchRecs = 64 * 1024;
+    }
+    ~CDbfColumnCache()
+    {
+        Close();
+    }
+
+    // ļ·
+    static std::string SidecarPath(const std::string& strFile)
+    {
+        return strFile + ".pdc";
+    }
+
+    // 򿪻棬治ڻʧЧʱɣvecColΪҪУΪʱΪȫֶ
+    int Load(const std::string& strFile, const std::vector<std::string>& vecCol = std::vector<std::string>())
+    {
+        if (Open(strFile) == CIDbf::DBF_SUCC && HasColumn(vecCol))
+        {
+            return CIDbf::DBF_SUCC;
+        }
+        Close();
+        int nRet = Build(strFile, vecCol);
+        return nRet ? nRet : Open(strFile);
+    }
+
+    // л沢У飬ʧЧʱDBF_CACHE_ERROR
+    int Open(const std::string& strFile)
+    {
+        Close();
+        TDbfColumnHeader oStamp;
+        std::vector<TDbfField> vecField;
+        if (Stamp(strFile, oStamp, vecField))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (Map(SidecarPath(strFile)))
+        {
+            return CIDbf::DBF_CACHE_ERROR;
+        }
+        const TDbfColumnHeader* pHeader = (const TDbfColumnHeader*)m_pData;
+        if (m_nSize < sizeof(TDbfColumnHeader) || memcmp(pHeader->szMagic, "PDCC", 4) || pHeader->nVersion != 2
+            || m_nSize < DelOffset(pHeader->nColNum) + pHeader->nRecNum
+            || !SameStamp(*pHeader, oStamp))
+        {
+            Close();
+            return CIDbf::DBF_CACHE_ERROR;
+        }
+        const TDbfColumnEntry* pEntry = (const TDbfColumnEntry*)(m_pData + sizeof(TDbfColumnHeader));
+        for (size_t i = 0; i < pHeader->nColNum; i++)
+        {
+            if (pEntry[i].nOffset + pEntry[i].nSize > m_nSize)
+            {
+                Close();
+                return CIDbf::DBF_CACHE_ERROR;
+            }
+        }
+        m_strFile = strFile;
+        m_vecField.swap(vecField);
+        return CIDbf::DBF_SUCC;
+    }
+
+    // жDBFļڴ򿪻Ƿ޸
+    bool IsStale()
+    {
+        TDbfColumnHeader oStamp;
+        std::vector<TDbfField> vecField;
+        if (!IsOpen() || Stamp(m_strFile, oStamp, vecField))
+        {
+            return true;
+        }
+        return !SameStamp(*(const TDbfColumnHeader*)m_pData, oStamp);
+    }
+
+    void Close()
+    {
+#ifndef _WIN32
+        if (m_pData)
+        {
+            munmap((void*)m_pData, m_nSize);
+        }
+#else
+        std::vector<char>().swap(m_vecData);
+#endif
+        m_pData = NULL;
+        m_nSize = 0;
+        m_strFile.clear();
+        m_vecField.clear();
+    }
+
+    // ɻ棬дʱļٸ
+    int Build(const std::string& strFile, const std::vector<std::string>& vecCol = std::vector<std::string>())
+    {
+        TDbfColumnHeader oHeader;
+        std::vector<TDbfField> vecField;
+        // ȡǰȡļ״̬ȡڼļ޸ʱᱻжΪʧЧ
+        if (Stamp(strFile, oHeader, vecField))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        CPDbf oDbf;
+        if (oDbf.Open(strFile))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (oDbf.GetRecNum() != oHeader.nRecNum)
+        {
+            return CIDbf::DBF_CACHE_ERROR;
+        }
+        // ѡ
+        std::vector<size_t> vecIdx;
+        for (size_t i = 0; i < (vecCol.empty() ? vecField.size() : vecCol.size()); i++)
+        {
+            size_t nIdx = vecCol.empty() ? i : CPDbf::FindField(vecField, vecCol[i]);
+            if (nIdx >= vecField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            vecIdx.push_back(nIdx);
+        }
+        // Ŀ¼ɾ־֮ÿ64ֽڶ
+        size_t nRecNum = oHeader.nRecNum;
+        oHeader.nColNum = (unsigned int)vecIdx.size();
+        std::vector<TDbfColumnEntry> vecEntry(vecIdx.size());
+        unsigned long long nDelOffset = DelOffset(vecEntry.size());
+        unsigned long long nOffset = Align(nDelOffset + nRecNum);
+        for (size_t i = 0; i < vecIdx.size(); i++)
+        {
+            const TDbfField& oField = vecField[vecIdx[i]];
+            TDbfColumnEntry& oEntry = vecEntry[i];
+            memcpy(oEntry.szName, oField.szName, sizeof(oEntry.szName));
+            oEntry.cType = oField.cType;
+            oEntry.cLength = oField.cLength;
+            oEntry.cPrecision = oField.cPrecisionLength;
+            oEntry.cColType = (unsigned char)ColType(oField);
+            oEntry.nOffset = nOffset;
+            oEntry.nSize = (unsigned long long)nRecNum * Width(oEntry);
+            nOffset = Align(nOffset + oEntry.nSize);
+        }
+
+        std::string strTemp = SidecarPath(strFile) + ".tmp";
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strTemp.c_str(), "wb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        int nRet = CIDbf::DBF_SUCC;
+        // ԤļСļͷд
+        if (ws_ftruncate(pFile, nOffset))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        std::vector<char> vecBuf;
+        const size_t nBatch = MMax(m_nBatchRecs, (size_t)1);
+        for (size_t nRecNo = 0; nRecNo < nRecNum && nRet == CIDbf::DBF_SUCC; nRecNo += nBatch)
+        {
+            size_t nNum = MMin(nBatch, nRecNum - nRecNo);
+            if (oDbf.Read(nRecNo, nNum))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+                break;
+            }
+            const char* pData = oDbf.ReadData(0);
+            // ɾ־Ϊ¼ĵһֽ
+            vecBuf.resize(nNum);
+            for (size_t i = 0; i < nNum; i++)
+            {
+                vecBuf[i] = pData[i * oDbf.GetRecLen()];
+            }
+            if (ws_fseek(pFile, nDelOffset + nRecNo, SEEK_SET) || fwrite(&vecBuf[0], 1, nNum, pFile) != nNum)
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+            for (size_t i = 0; i < vecIdx.size() && nRet == CIDbf::DBF_SUCC; i++)
+            {
+                const TDbfColumnEntry& oEntry = vecEntry[i];
+                size_t nWidth = Width(oEntry);
+                vecBuf.resize(nNum * nWidth);
+                Transpose(pData + vecField[vecIdx[i]].nPosition, oDbf.GetRecLen(), nNum, oEntry, &vecBuf[0]);
+                if (ws_fseek(pFile, oEntry.nOffset + (unsigned long long)nRecNo * nWidth, SEEK_SET)
+                    || fwrite(&vecBuf[0], 1, vecBuf.size(), pFile) != vecBuf.size())
+                {
+                    nRet = CIDbf::DBF_FILE_ERROR;
+                }
+            }
+        }
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            if (fseek(pFile, 0, SEEK_SET)
+                || fwrite(&oHeader, 1, sizeof(oHeader), pFile) != sizeof(oHeader)
+                || (!vecEntry.empty() && fwrite(&vecEntry[0], sizeof(TDbfColumnEntry), vecEntry.size(), pFile) != vecEntry.size()))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        if (fclose(pFile))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            remove(SidecarPath(strFile).c_str());
+            if (rename(strTemp.c_str(), SidecarPath(strFile).c_str()))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        if (nRet)
+        {
+            remove(strTemp.c_str());
+        }
+        return nRet;
+    }
+
+    inline bool IsOpen() const { return m_pData != NULL; }
+    inline size_t GetRecNum() const { return IsOpen() ? Header().nRecNum : 0; }
+    inline size_t GetColNum() const { return IsOpen() ? Header().nColNum : 0; }
+    // Ϣ
+    inline const TDbfColumnEntry& GetColumn(size_t nCol) const { return Entry()[nCol]; }
+    // ֶУʱnpos
+    size_t FindColumn(const std::string& strName) const
+    {
+        for (size_t i = 0; i < GetColNum(); i++)
+        {
+            if (strName == std::string(Entry()[i].szName, strnlen(Entry()[i].szName, sizeof(Entry()[i].szName))))
+            {
+                return i;
+            }
+        }
+        return npos;
+    }
+    // ɾ־Уÿ¼1ֽڣ'*'Ϊɾ
+    inline const char* DelFlag() const { return IsOpen() ? m_pData + DelOffset(Header().nColNum) : NULL; }
+    inline bool IsDeleted(size_t nRecNo) const { return DelFlag()[nRecNo] == '*'; }
+    // ݣͲʱNULL
+    const double* Double(size_t nCol) const
+    {
+        return nCol < GetColNum() && Entry()[nCol].cColType == DBF_COL_DOUBLE ? (const double*)(m_pData + Entry()[nCol].nOffset) : NULL;
+    }
+    const long long* Int64(size_t nCol) const
+    {
+        return nCol < GetColNum() && Entry()[nCol].cColType == DBF_COL_INT64 ? (const long long*)(m_pData + Entry()[nCol].nOffset) : NULL;
+    }
+    // ԭʼֽУÿ¼ռֶγȸֽ
+    const char* Bytes(size_t nCol) const
+    {
+        return nCol < GetColNum() && Entry()[nCol].cColType == DBF_COL_BYTES ? m_pData + Entry()[nCol].nOffset : NULL;
+    }
+    // doubleȡֵУתΪdouble
+    double GetDouble(size_t nCol, size_t nRecNo) const
+    {
+        const TDbfColumnEntry& oEntry = Entry()[nCol];
+        if (oEntry.cColType == DBF_COL_DOUBLE)
+        {
+            return Double(nCol)[nRecNo];
+        }
+        if (oEntry.cColType == DBF_COL_INT64)
+        {
+            return (double)Int64(nCol)[nRecNo];
+        }
+        return CDbfFastParse::ToDouble(Bytes(nCol) + nRecNo * oEntry.cLength, oEntry.cLength);
+    }
+
+public:
+    // ɻʱÿȡļ¼
+    size_t m_nBatchRecs;
+
+private:
+    CDbfColumnCache(const CDbfColumnCache&);
+    CDbfColumnCache& operator=(const CDbfColumnCache&);
+
+    inline const TDbfColumnHeader& Header() const { return *(const TDbfColumnHeader*)m_pData; }
+    inline const TDbfColumnEntry* Entry() const { return (const TDbfColumnEntry*)(m_pData + sizeof(TDbfColumnHeader)); }
+
+    static unsigned long long Align(unsigned long long nSize)
+    {
+        return (nSize + 63) & ~63ULL;
+    }
+    // ɾ־нĿ¼
+    static unsigned long long DelOffset(size_t nColNum)
+    {
+        return Align(sizeof(TDbfColumnHeader) + (unsigned long long)nColNum * sizeof(TDbfColumnEntry));
+    }
+    static int ColType(const TDbfField& oField)
+    {
+        if (oField.cType == 'N' || oField.cType == 'F')
+        {
+            // 15λڵdoubleǾȷֵΪlong long
+            return oField.cPrecisionLength == 0 && oField.cLength <= 15 ? DBF_COL_INT64 : DBF_COL_DOUBLE;
+        }
+        return DBF_COL_BYTES;
+    }
+    static size_t Width(const TDbfColumnEntry& oEntry)
+    {
+        return oEntry.cColType == DBF_COL_BYTES ? oEntry.cLength : 8;
+    }
+    // һ¼еһֶתΪ
+    static void Transpose(const char* pField, size_t nRecLen, size_t nNum, const TDbfColumnEntry& oEntry, char* pOut)
+    {
+        if (oEntry.cColType == DBF_COL_DOUBLE)
+        {
+            double* pValue = (double*)pOut;
+            for (size_t i = 0; i < nNum; i++, pField += nRecLen)
+            {
+                pValue[i] = CDbfFastParse::ToDouble(pField, oEntry.cLength);
+            }
+        }
+        else if (oEntry.cColType == DBF_COL_INT64)
+        {
+            long long* pValue = (long long*)pOut;
+            for (size_t i = 0; i < nNum; i++, pField += nRecLen)
+            {
+                pValue[i] = (long long)CDbfFastParse::ToDouble(pField, oEntry.cLength);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < nNum; i++, pField += nRecLen, pOut += oEntry.cLength)
+            {
+                memcpy(pOut, pField, oEntry.cLength);
+            }
+        }
+    }
+
+    // жϻǷҪУvecColΪʱDBFļȫֶ
+    bool HasColumn(const std::vector<std::string>& vecCol) const
+    {
+        if (vecCol.empty())
+        {
+            for (size_t i = 0; i < m_vecField.size(); i++)
+            {
+                if (FindColumn(std::string(m_vecField[i].szName, strnlen(m_vecField[i].szName, sizeof(m_vecField[i].szName)))) == npos)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        for (size_t i = 0; i < vecCol.size(); i++)
+        {
+            if (FindColumn(vecCol[i]) == npos)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // DBFļǰ״̬С޸ʱ䡢ļͷֶζϣ
+    static int Stamp(const std::string& strFile, TDbfColumnHeader& oStamp, std::vector<TDbfField>& vecField)
+    {
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strFile.c_str(), "rb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        TDbfHeader oHeader;
+        int nRet = ws_fstat(pFile, &oStamp.nFileSize, &oStamp.nMTime) ? CIDbf::DBF_FILE_ERROR : CIDbf::DBF_SUCC;
+        if (nRet == CIDbf::DBF_SUCC && fread(&oHeader, 1, sizeof(oHeader), pFile) != sizeof(oHeader))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        std::vector<char> vecHead;
+        if (nRet == CIDbf::DBF_SUCC && oHeader.nHeaderLen > sizeof(oHeader))
+        {
+            vecHead.resize(oHeader.nHeaderLen - sizeof(oHeader));
+            if (fread(&vecHead[0], 1, vecHead.size(), pFile) != vecHead.size())
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        fclose(pFile);
+        std::map<std::string, size_t> mapField;
+        if (nRet || vecHead.empty() || CPDbf::ParseField(&vecHead[0], vecHead.size(), vecField, mapField))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        oStamp.nRecNum = oHeader.nRecNum;
+        oStamp.nHeaderLen = oHeader.nHeaderLen;
+        oStamp.nRecLen = oHeader.nRecLen;
+        oStamp.nLayout = CXXHash64::Hash(&vecHead[0], vecHead.size());
+        return CIDbf::DBF_SUCC;
+    }
+    static bool SameStamp(const TDbfColumnHeader& a, const TDbfColumnHeader& b)
+    {
+        return a.nFileSize == b.nFileSize && a.nMTime == b.nMTime && a.nLayout == b.nLayout
+            && a.nRecNum == b.nRecNum && a.nHeaderLen == b.nHeaderLen && a.nRecLen == b.nRecLen;
+    }
+
+    // ӳ仺ļ
+    int Map(const std::string& strPath)
+    {
+#ifndef _WIN32
+        int nFd = open(strPath.c_str(), O_RDONLY);
+        if (nFd < 0)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        unsigned long long nSize = 0;
+        long long nMTime = 0;
+        void* pData = MAP_FAILED;
+        if (ws_fstat_fd(nFd, &nSize, &nMTime) == 0 && nSize > 0)
+        {
+            pData = mmap(NULL, (size_t)nSize, PROT_READ, MAP_SHARED, nFd, 0);
+        }
+        close(nFd);
+        if (pData == MAP_FAILED)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_pData = (const char*)pData;
+        m_nSize = (size_t)nSize;
+#else
+        CDbfMemFile oFile;
+        if (oFile.Open(strPath, true) || oFile.Size() == 0)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_vecData.assign(oFile.Data(), oFile.Data() + oFile.Size());
+        m_pData = &m_vecData[0];
+        m_nSize = m_vecData.size();
+#endif
+        return CIDbf::DBF_SUCC;
+    }
+
+private:
+    // DBFļ·ֶζ
+    std::string m_strFile;
+    std::vector<TDbfField> m_vecField;
+    // ӳĻļ
+    const char* m_pData;
+    size_t m_nSize;
+#ifdef _WIN32
+    std::vector<char> m_vecData;
+#endif
+};
+
+#endif
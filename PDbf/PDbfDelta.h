@@ -0,0 +1,403 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_DELTA_H__
+#define __P_DBF_DELTA_H__
+#include "PDbf.h"
+#include "PDbfDigest.h"
+
+// DBFļͷ
+// ļʽ: ļͷ + nRunNumΣ = TDbfDeltaRun + nNumԭʼ¼
+// ΰ¼У¼ŲСnOldRecNumıΪ׷Ӽ¼
+// nNewRecNumСnOldRecNumʱض϶ļ¼nBaseHashΪɰ汾ȫ¼УֵӦǰУĿļ
+class TDbfDeltaHeader
+{
+public:
+    char            szMagic[4];     // ־"PDBD"
+    unsigned int    nVersion;       // ʽ汾
+    unsigned int    nHeaderLen;     // DBFļͷ
+    unsigned int    nRecLen;        // ¼
+    unsigned int    nLayout;        // ֶβУֵ
+    unsigned int    nOldRecNum;     // ɰ汾¼
+    unsigned int    nNewRecNum;     // °汾¼
+    unsigned int    nRunNum;        // 
+    unsigned long long nBaseHash;   // ɰ汾¼Уֵ
+
+    TDbfDeltaHeader()
+    {
+        assert(sizeof(*this) == 40);
+        memcpy(szMagic, "PDBD", sizeof(szMagic));
+        nVersion = 2;
+        nHeaderLen = 0;
+        nRecLen = 0;
+        nLayout = 0;
+        nOldRecNum = 0;
+        nNewRecNum = 0;
+        nRunNum = 0;
+        nBaseHash = 0;
+    }
+};
+// Σ¼һ¼
+class TDbfDeltaRun
+{
+public:
+    unsigned int    nRecNo;         // ʼ¼
+    unsigned int    nNum;           // ¼
+
+    TDbfDeltaRun()
+    {
+        nRecNo = 0;
+        nNum = 0;
+    }
+};
+
+// DBFɼӦ
+// 汾ֶβֱһ£¼űȽϣɾ־仯ҲΪ¼
+class CDbfDelta
+{
+public:
+    CDbfDelta()
+    {
+        m_nReadNum = 10000;
+        m_nMaxRunNum = 4096;
+        m_nChangeRecs = 0;
+        m_nAppendRecs = 0;
+        m_nDeleteRecs = 0;
+        m_pFile = NULL;
+        m_nRecLen = 0;
+        m_nRunNum = 0;
+    }
+public:
+    // ÿȡļ¼
+    size_t m_nReadNum;
+    // ¼
+    size_t m_nMaxRunNum;
+    // һɻӦõı¼
+    size_t m_nChangeRecs;
+    // һɻӦõ׷Ӽ¼
+    size_t m_nAppendRecs;
+    // һɻӦõɾ¼
+    size_t m_nDeleteRecs;
+
+    // strOldstrNewĲļ
+    int Make(const std::string& strOld, const std::string& strNew, const std::string& strDelta)
+    {
+        CPDbf oOld;
+        CPDbf oNew;
+        if (oOld.Open(strOld, true) || oNew.Open(strNew, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (!CCMPDbf::IsSameLayout(oOld, oNew) || oOld.GetHeader().nHeaderLen != oNew.GetHeader().nHeaderLen)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strDelta.c_str(), "wb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_pFile = pFile;
+        m_nRecLen = oNew.GetRecLen();
+        m_vecRun.clear();
+        m_oRun = TDbfDeltaRun();
+        m_nRunNum = 0;
+        m_nChangeRecs = 0;
+        m_nAppendRecs = 0;
+        m_nDeleteRecs = 0;
+
+        TDbfDeltaHeader oHeader;
+        oHeader.nHeaderLen = oNew.GetHeader().nHeaderLen;
+        oHeader.nRecLen = (unsigned int)m_nRecLen;
+        oHeader.nLayout = Layout(oNew.GetField());
+        oHeader.nOldRecNum = (unsigned int)oOld.GetRecNum();
+        oHeader.nNewRecNum = (unsigned int)oNew.GetRecNum();
+        int nRet = fwrite(&oHeader, 1, sizeof(oHeader), pFile) == sizeof(oHeader) ? CIDbf::DBF_SUCC : CIDbf::DBF_FILE_ERROR;
+
+        // ȽϹм¼
+        size_t nOldNum = oOld.GetRecNum();
+        size_t nNewNum = oNew.GetRecNum();
+        size_t nCmpNum = MMin(nOldNum, nNewNum);
+        const size_t nBatch = MMax(m_nReadNum, (size_t)1);
+        size_t nReadNum = nBatch;
+        unsigned long long nBaseHash = 0;
+        for (size_t i = 0; i < nCmpNum && nRet == CIDbf::DBF_SUCC; i += nReadNum)
+        {
+            nReadNum = MMin(nReadNum, nCmpNum - i);
+            if (oOld.Read(i, nReadNum) || oNew.Read(i, nReadNum))
+            {
+                nRet = CIDbf::DBF_ERROR;
+                break;
+            }
+            const char* pOld = oOld.ReadData();
+            const char* pNew = oNew.ReadData();
+            nBaseHash = HashRec(pOld, nReadNum, nBaseHash);
+            if (memcmp(pOld, pNew, nReadNum * m_nRecLen) == 0)
+            {
+                continue;
+            }
+            for (size_t j = 0; j < nReadNum && nRet == CIDbf::DBF_SUCC; j++)
+            {
+                size_t nOffset = j * m_nRecLen;
+                if (memcmp(pOld + nOffset, pNew + nOffset, m_nRecLen))
+                {
+                    nRet = PushRec(i + j, pNew + nOffset);
+                    m_nChangeRecs++;
+                }
+            }
+        }
+
+        // ׷Ӽ¼
+        nReadNum = nBatch;
+        for (size_t i = nCmpNum; i < nNewNum && nRet == CIDbf::DBF_SUCC; i += nReadNum)
+        {
+            nReadNum = MMin(nReadNum, nNewNum - i);
+            if (oNew.Read(i, nReadNum))
+            {
+                nRet = CIDbf::DBF_ERROR;
+                break;
+            }
+            const char* pNew = oNew.ReadData();
+            for (size_t j = 0; j < nReadNum && nRet == CIDbf::DBF_SUCC; j++)
+            {
+                nRet = PushRec(i + j, pNew + j * m_nRecLen);
+            }
+            m_nAppendRecs += nReadNum;
+        }
+        m_nDeleteRecs = nOldNum > nNewNum ? nOldNum - nNewNum : 0;
+
+        // ضϵľɼ¼ҲУֵ
+        nReadNum = nBatch;
+        for (size_t i = nCmpNum; i < nOldNum && nRet == CIDbf::DBF_SUCC; i += nReadNum)
+        {
+            nReadNum = MMin(nReadNum, nOldNum - i);
+            if (oOld.Read(i, nReadNum))
+            {
+                nRet = CIDbf::DBF_ERROR;
+                break;
+            }
+            nBaseHash = HashRec(oOld.ReadData(), nReadNum, nBaseHash);
+        }
+
+        // һβдļͷ
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = FlushRun();
+        }
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            oHeader.nRunNum = m_nRunNum;
+            oHeader.nBaseHash = nBaseHash;
+            if (fseek(pFile, 0, SEEK_SET) || fwrite(&oHeader, 1, sizeof(oHeader), pFile) != sizeof(oHeader))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        if (fclose(pFile) && nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        m_pFile = NULL;
+        return nRet;
+    }
+
+    // ļӦõstrDbfĿļɲʱľɰ汾һ£дǰУȫ¼һʱDBF_PARA_ERROR
+    // ΰ¼˳д룬Ӧ;ʧʱļڲָ״̬
+    int Apply(const std::string& strDbf, const std::string& strDelta)
+    {
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strDelta.c_str(), "rb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        int nRet = ApplyFile(strDbf, pFile);
+        fclose(pFile);
+        return nRet;
+    }
+
+    // ֶβУֵ(FNV-1a)
+    static unsigned int Layout(const std::vector<TDbfField>& vecField)
+    {
+        unsigned int nHash = 2166136261U;
+        for (size_t i = 0; i < vecField.size(); i++)
+        {
+            const TDbfField& oField = vecField[i];
+            unsigned char szKey[sizeof(oField.szName) + 3] = { 0 };
+            memcpy(szKey, oField.szName, sizeof(oField.szName));
+            szKey[sizeof(oField.szName)] = oField.cType;
+            szKey[sizeof(oField.szName) + 1] = oField.cLength;
+            szKey[sizeof(oField.szName) + 2] = oField.cPrecisionLength;
+            for (size_t k = 0; k < sizeof(szKey); k++)
+            {
+                nHash = (nHash ^ szKey[k]) * 16777619U;
+            }
+        }
+        return nHash;
+    }
+
+private:
+    int ApplyFile(const std::string& strDbf, FILE* pFile)
+    {
+        TDbfDeltaHeader oHeader;
+        if (fread(&oHeader, 1, sizeof(oHeader), pFile) != sizeof(oHeader)
+            || memcmp(oHeader.szMagic, "PDBD", sizeof(oHeader.szMagic)) || oHeader.nVersion != 2)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+
+        CPDbf oDbf;
+        if (oDbf.Open(strDbf, false))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        // УĿļ汾
+        if (oDbf.GetHeader().nHeaderLen != oHeader.nHeaderLen || oDbf.GetRecLen() != oHeader.nRecLen
+            || oDbf.GetRecNum() != oHeader.nOldRecNum || Layout(oDbf.GetField()) != oHeader.nLayout)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        // УĿļ¼ɰ汾һ£ѱ޸ĵļϻ¾ɼ¼
+        size_t nRecLen = oHeader.nRecLen;
+        m_nRecLen = nRecLen;
+        std::vector<char> vecBuf(nRecLen * MMax(m_nReadNum, (size_t)1));
+        size_t nBufNum = vecBuf.size() / nRecLen;
+        unsigned long long nBaseHash = 0;
+        for (size_t i = 0; i < oHeader.nOldRecNum; i += nBufNum)
+        {
+            size_t nNum = MMin(nBufNum, oHeader.nOldRecNum - i);
+            if (oDbf.ReadRecord(i, &vecBuf[0], nNum))
+            {
+                return CIDbf::DBF_ERROR;
+            }
+            nBaseHash = HashRec(&vecBuf[0], nNum, nBaseHash);
+        }
+        if (nBaseHash != oHeader.nBaseHash)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+
+        m_nChangeRecs = 0;
+        m_nAppendRecs = 0;
+        m_nDeleteRecs = oHeader.nOldRecNum > oHeader.nNewRecNum ? oHeader.nOldRecNum - oHeader.nNewRecNum : 0;
+        for (unsigned int i = 0; i < oHeader.nRunNum; i++)
+        {
+            TDbfDeltaRun oRun;
+            if (fread(&oRun, 1, sizeof(oRun), pFile) != sizeof(oRun) || oRun.nRecNo > oDbf.GetRecNum())
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            // ηȡд
+            for (size_t n = 0; n < oRun.nNum; n += nBufNum)
+            {
+                size_t nNum = MMin(nBufNum, oRun.nNum - n);
+                if (fread(&vecBuf[0], 1, nNum * nRecLen, pFile) != nNum * nRecLen)
+                {
+                    return CIDbf::DBF_FILE_ERROR;
+                }
+                if (oDbf.WriteRecord(oRun.nRecNo + n, &vecBuf[0], nNum))
+                {
+                    return CIDbf::DBF_ERROR;
+                }
+            }
+            if (oRun.nRecNo >= oHeader.nOldRecNum)
+            {
+                m_nAppendRecs += oRun.nNum;
+            }
+            else
+            {
+                m_nChangeRecs += oRun.nNum;
+            }
+        }
+
+        // ɾļ¼
+        if (oHeader.nNewRecNum < oDbf.GetRecNum() && oDbf.Truncate(oHeader.nNewRecNum))
+        {
+            return CIDbf::DBF_ERROR;
+        }
+        oDbf.Close();
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ¼ۼУֵÿȡļ¼޹
+    unsigned long long HashRec(const char* pData, size_t nNum, unsigned long long nHash)
+    {
+        for (size_t i = 0; i < nNum; i++, pData += m_nRecLen)
+        {
+            nHash = CXXHash64::Hash(pData, m_nRecLen, nHash);
+        }
+        return nHash;
+    }
+
+    // ӱ¼뵱ǰʱϲ
+    int PushRec(size_t nRecNo, const char* pRec)
+    {
+        if (m_oRun.nNum && (m_oRun.nRecNo + m_oRun.nNum != nRecNo || m_oRun.nNum >= m_nMaxRunNum))
+        {
+            int nRet = FlushRun();
+            if (nRet)
+            {
+                return nRet;
+            }
+        }
+        if (!m_oRun.nNum)
+        {
+            m_oRun.nRecNo = (unsigned int)nRecNo;
+        }
+        m_vecRun.insert(m_vecRun.end(), pRec, pRec + m_nRecLen);
+        m_oRun.nNum++;
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ǰ
+    int FlushRun()
+    {
+        if (!m_oRun.nNum)
+        {
+            return CIDbf::DBF_SUCC;
+        }
+        if (fwrite(&m_oRun, 1, sizeof(m_oRun), m_pFile) != sizeof(m_oRun)
+            || fwrite(&m_vecRun[0], 1, m_vecRun.size(), m_pFile) != m_vecRun.size())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_nRunNum++;
+        m_oRun = TDbfDeltaRun();
+        m_vecRun.clear();
+        return CIDbf::DBF_SUCC;
+    }
+
+private:
+    // ļ
+    FILE* m_pFile;
+    // ¼
+    size_t m_nRecLen;
+    // ǰ
+    TDbfDeltaRun m_oRun;
+    // ǰμ¼
+    std::vector<char> m_vecRun;
+    // ı
+    unsigned int m_nRunNum;
+};
+
+#endif
@@ -0,0 +1,356 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_DIGEST_H__
+#define __P_DBF_DIGEST_H__
+#include "PDbf.h"
+
+// 64λϣ(xxHash64㷨)
+class CXXHash64
+{
+public:
+    typedef unsigned long long uint64;
+
+    static uint64 Hash(const void* pData, size_t nLen, uint64 nSeed = 0)
+    {
+        const unsigned char* p = (const unsigned char*)pData;
+        const unsigned char* pEnd = p + nLen;
+        uint64 h = 0;
+        if (nLen >= 32)
+        {
+            const unsigned char* pLimit = pEnd - 32;
+            uint64 v1 = nSeed + P1 + P2;
+            uint64 v2 = nSeed + P2;
+            uint64 v3 = nSeed;
+            uint64 v4 = nSeed - P1;
+            do
+            {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= pLimit);
+            h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+            h = Merge(h, v1);
+            h = Merge(h, v2);
+            h = Merge(h, v3);
+            h = Merge(h, v4);
+        }
+        else
+        {
+            h = nSeed + P5;
+        }
+        h += (uint64)nLen;
+        while (p + 8 <= pEnd)
+        {
+            h ^= Round(0, Read64(p));
+            h = Rotl(h, 27) * P1 + P4;
+            p += 8;
+        }
+        if (p + 4 <= pEnd)
+        {
+            h ^= (uint64)Read32(p) * P1;
+            h = Rotl(h, 23) * P2 + P3;
+            p += 4;
+        }
+        while (p < pEnd)
+        {
+            h ^= (*p) * P5;
+            h = Rotl(h, 11) * P1;
+            p++;
+        }
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static const uint64 P1 = 11400714785074694791ULL;
+    static const uint64 P2 = 14029467366897019727ULL;
+    static const uint64 P3 = 1609587929392839161ULL;
+    static const uint64 P4 = 9650029242287828579ULL;
+    static const uint64 P5 = 2870177450012600261ULL;
+
+    static inline uint64 Rotl(uint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+    static inline uint64 Round(uint64 nAcc, uint64 nInput)
+    {
+        nAcc += nInput * P2;
+        nAcc = Rotl(nAcc, 31);
+        return nAcc * P1;
+    }
+    static inline uint64 Merge(uint64 nAcc, uint64 nVal)
+    {
+        nAcc ^= Round(0, nVal);
+        return nAcc * P1 + P4;
+    }
+    // Сֽȡ
+    static inline uint64 Read64(const unsigned char* p)
+    {
+        return (uint64)Read32(p) | ((uint64)Read32(p + 4) << 32);
+    }
+    static inline unsigned int Read32(const unsigned char* p)
+    {
+        return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+    }
+};
+
+// ¼
+class TDbfRange
+{
+public:
+    size_t nRecNo;      // ʼ¼
+    size_t nNum;        // ¼
+
+    TDbfRange(size_t nBegin = 0, size_t nCount = 0)
+    {
+        nRecNo = nBegin;
+        nNum = nCount;
+    }
+};
+
+// ֿժҪļͷ
+class TDbfDigestHeader
+{
+public:
+    char            szMagic[4];     // ־"PDBG"
+    unsigned int    nVersion;       // ʽ汾
+    unsigned int    nBlockRecs;     // ÿ¼
+    unsigned int    nRecNum;        // ¼
+    unsigned int    nRecLen;        // ¼
+    unsigned int    nHeaderLen;     // DBFļͷ
+    unsigned int    nBlockNum;      // 
+    unsigned int    nReserved;      // 
+
+    TDbfDigestHeader()
+    {
+        assert(sizeof(*this) == 32);
+        memcpy(szMagic, "PDBG", sizeof(szMagic));
+        nVersion = 1;
+        nBlockRecs = 0;
+        nRecNum = 0;
+        nRecLen = 0;
+        nHeaderLen = 0;
+        nBlockNum = 0;
+        nReserved = 0;
+    }
+};
+
+// DBFֿժҪ̶¼ֿxxHash64
+// ļдʱȽǰժҪɵõ仯ļ¼䣬ֻ仯Ŀ
+class CDbfDigest
+{
+public:
+    CDbfDigest(size_t nBlockRecs = 1024)
+    {
+        m_oHeader.nBlockRecs = (unsigned int)MMax(nBlockRecs, (size_t)1);
+        m_nReadBlocks = 16;
+    }
+public:
+    // ÿζȡĿ
+    size_t m_nReadBlocks;
+
+    // ļժҪ
+    int Build(CPDbf& oDbf)
+    {
+        if (!oDbf.IsOpen())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        TDbfHeader oDbfHeader = oDbf.GetHeader();
+        size_t nBlockRecs = m_oHeader.nBlockRecs;
+        size_t nRecNum = oDbf.GetRecNum();
+        size_t nRecLen = oDbf.GetRecLen();
+        std::vector<CXXHash64::uint64> vecDigest((nRecNum + nBlockRecs - 1) / nBlockRecs);
+        size_t nReadNum = nBlockRecs * MMax(m_nReadBlocks, (size_t)1);
+        for (size_t i = 0; i < nRecNum; i += nReadNum)
+        {
+            size_t nNum = MMin(nReadNum, nRecNum - i);
+            if (oDbf.Read(i, nNum))
+            {
+                return CIDbf::DBF_ERROR;
+            }
+            const char* pData = oDbf.ReadData();
+            for (size_t j = 0; j < nNum; j += nBlockRecs)
+            {
+                size_t nBlockNum = MMin(nBlockRecs, nNum - j);
+                vecDigest[(i + j) / nBlockRecs] = CXXHash64::Hash(pData + j * nRecLen, nBlockNum * nRecLen);
+            }
+        }
+        m_oHeader.nRecNum = (unsigned int)nRecNum;
+        m_oHeader.nRecLen = (unsigned int)nRecLen;
+        m_oHeader.nHeaderLen = oDbfHeader.nHeaderLen;
+        m_oHeader.nBlockNum = (unsigned int)vecDigest.size();
+        m_vecDigest.swap(vecDigest);
+        return CIDbf::DBF_SUCC;
+    }
+    int Build(const std::string& strFile)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return Build(oDbf);
+    }
+
+    // ¼ժҪһժҪȱ仯ļ¼(ļ¼)
+    // ¼ʱɾļ¼ڷУͨGetRecNumȽϵõ
+    int Update(CPDbf& oDbf, std::vector<TDbfRange>& vecChanged)
+    {
+        CDbfDigest oOld(*this);
+        int nRet = Build(oDbf);
+        if (nRet)
+        {
+            return nRet;
+        }
+        Diff(oOld, *this, vecChanged);
+        return CIDbf::DBF_SUCC;
+    }
+    int Update(const std::string& strFile, std::vector<TDbfRange>& vecChanged)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return Update(oDbf, vecChanged);
+    }
+
+    // ȽժҪڵı仯ϲΪһ
+    static void Diff(const CDbfDigest& oOld, const CDbfDigest& oNew, std::vector<TDbfRange>& vecChanged)
+    {
+        vecChanged.clear();
+        size_t nRecNum = oNew.m_oHeader.nRecNum;
+        size_t nBlockRecs = oNew.m_oHeader.nBlockRecs;
+        // ֻֿ鷽ʽͬȫΪ仯
+        bool bAll = oOld.m_oHeader.nBlockRecs != oNew.m_oHeader.nBlockRecs
+            || oOld.m_oHeader.nRecLen != oNew.m_oHeader.nRecLen
+            || oOld.m_oHeader.nHeaderLen != oNew.m_oHeader.nHeaderLen;
+        for (size_t i = 0; i < oNew.m_vecDigest.size(); i++)
+        {
+            // ļĩβĿ鼰鶼ժҪ򳤶ȲͬΪ仯
+            bool bSame = !bAll && i < oOld.m_vecDigest.size()
+                && oOld.m_vecDigest[i] == oNew.m_vecDigest[i]
+                && oOld.BlockNum(i) == oNew.BlockNum(i);
+            if (bSame)
+            {
+                continue;
+            }
+            size_t nBegin = i * nBlockRecs;
+            size_t nNum = MMin(nBlockRecs, nRecNum - nBegin);
+            if (!vecChanged.empty() && vecChanged.back().nRecNo + vecChanged.back().nNum == nBegin)
+            {
+                vecChanged.back().nNum += nNum;
+            }
+            else
+            {
+                vecChanged.push_back(TDbfRange(nBegin, nNum));
+            }
+        }
+    }
+
+    // ժҪļ
+    int Save(const std::string& strFile) const
+    {
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strFile.c_str(), "wb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        int nRet = CIDbf::DBF_SUCC;
+        size_t nSize = m_vecDigest.size() * sizeof(CXXHash64::uint64);
+        if (fwrite(&m_oHeader, 1, sizeof(m_oHeader), pFile) != sizeof(m_oHeader)
+            || (nSize && fwrite(&m_vecDigest[0], 1, nSize, pFile) != nSize))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        if (fclose(pFile))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        return nRet;
+    }
+    // ӸļժҪ
+    int Load(const std::string& strFile)
+    {
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strFile.c_str(), "rb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        TDbfDigestHeader oHeader;
+        int nRet = CIDbf::DBF_SUCC;
+        if (fread(&oHeader, 1, sizeof(oHeader), pFile) != sizeof(oHeader)
+            || memcmp(oHeader.szMagic, "PDBG", sizeof(oHeader.szMagic)) || oHeader.nVersion != 1
+            || oHeader.nBlockRecs == 0)
+        {
+            fclose(pFile);
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        std::vector<CXXHash64::uint64> vecDigest(oHeader.nBlockNum);
+        size_t nSize = vecDigest.size() * sizeof(CXXHash64::uint64);
+        if (nSize && fread(&vecDigest[0], 1, nSize, pFile) != nSize)
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        fclose(pFile);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            m_oHeader = oHeader;
+            m_vecDigest.swap(vecDigest);
+        }
+        return nRet;
+    }
+    // Ĭϸļ
+    static std::string SidecarPath(const std::string& strDbf)
+    {
+        return strDbf + ".pdg";
+    }
+
+    // ժҪӦļ¼
+    inline size_t GetRecNum() const { return m_oHeader.nRecNum; }
+    // ÿ¼
+    inline size_t GetBlockRecs() const { return m_oHeader.nBlockRecs; }
+    // ժҪ
+    inline const std::vector<CXXHash64::uint64>& GetDigest() const { return m_vecDigest; }
+
+private:
+    // nBlockļ¼
+    size_t BlockNum(size_t nBlock) const
+    {
+        size_t nBegin = nBlock * m_oHeader.nBlockRecs;
+        return MMin((size_t)m_oHeader.nBlockRecs, m_oHeader.nRecNum - nBegin);
+    }
+
+private:
+    // ժҪͷ
+    TDbfDigestHeader m_oHeader;
+    // ժҪ
+    std::vector<CXXHash64::uint64> m_vecDigest;
+};
+
+#endif
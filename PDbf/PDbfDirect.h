@@ -0,0 +1,322 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_DIRECT_H__
+#define __P_DBF_DIRECT_H__
+#include <functional>
+#include "PDbf.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+// ҳ˳ɨ
+// һȫɨļ⼷ȵļ档O_DIRECT򿪣
+// 4Kȡ¼ʼλü¼߽粻ڲļϵͳ֧O_DIRECTʱ˻ͨȡ
+// ÿͨfadvise(DONTNEED)֪ͨں˶÷Χҳ(ļڻеҳҲᱻ)
+// WindowsΪͨȡ
+class CDbfDirectScan
+{
+public:
+    enum
+    {
+        ALIGN_SIZE = 4096,      // O_DIRECTҪƫơȼڴ
+    };
+    // ɨصpDataΪӵnRecNoʼnNum¼ط0ʱֹͣɨ
+    typedef std::function<int(const char* pData, size_t nRecNo, size_t nNum)> TCallback;
+
+    CDbfDirectScan()
+    {
+        m_bDirect = true;
+        m_bDropCache = true;
+        m_nBatchRecs = 0;
+        m_nBatchSize = 4 * 1024 * 1024;
+        m_nFd = -1;
+        m_bIsDirect = false;
+        m_pBuf = NULL;
+        m_nBufSize = 0;
+        m_pData = NULL;
+        m_nRecNum = 0;
+        m_nRecordOffset = 0;
+    }
+    ~CDbfDirectScan()
+    {
+        Close();
+        FreeBuf();
+    }
+
+    // ļȡļͷֶ
+    int Open(const std::string& strFile)
+    {
+        Close();
+#ifndef _WIN32
+#ifdef O_DIRECT
+        if (m_bDirect)
+        {
+            m_nFd = open(strFile.c_str(), O_RDONLY | O_DIRECT);
+            m_bIsDirect = m_nFd >= 0;
+        }
+#endif
+        if (m_nFd < 0)
+        {
+            m_nFd = open(strFile.c_str(), O_RDONLY);
+        }
+        if (m_nFd < 0)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        if (!m_bIsDirect)
+        {
+            posix_fadvise(m_nFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+#endif
+#else
+        if (m_oFile.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+#endif
+        // ļͷֶ
+        const char* pHead = ReadRange(0, sizeof(TDbfHeader));
+        if (!pHead)
+        {
+            Close();
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        memcpy(&m_oHeader, pHead, sizeof(m_oHeader));
+        std::map<std::string, size_t> mapField;
+        pHead = m_oHeader.nHeaderLen > sizeof(TDbfHeader) ? ReadRange(0, m_oHeader.nHeaderLen) : NULL;
+        if (!pHead || CPDbf::ParseField(pHead + sizeof(TDbfHeader), m_oHeader.nHeaderLen - sizeof(TDbfHeader), m_vecField, mapField)
+            || m_oHeader.nRecLen == 0)
+        {
+            Close();
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_nRecordOffset = m_oHeader.nHeaderLen + CPDbf::GetRemarkSize(m_oHeader.cVer);
+        DropCache(0, m_nRecordOffset);
+        return CIDbf::DBF_SUCC;
+    }
+
+    void Close()
+    {
+#ifndef _WIN32
+        if (m_nFd >= 0)
+        {
+            close(m_nFd);
+        }
+        m_nFd = -1;
+#else
+        m_oFile.Close();
+#endif
+        m_bIsDirect = false;
+        m_oHeader = TDbfHeader();
+        m_vecField.clear();
+        m_pData = NULL;
+        m_nRecNum = 0;
+    }
+
+    inline bool IsOpen() const
+    {
+#ifndef _WIN32
+        return m_nFd >= 0;
+#else
+        return m_oFile.IsOpen();
+#endif
+    }
+    // ǷO_DIRECT
+    inline bool IsDirect() const { return m_bIsDirect; }
+    inline size_t GetRecNum() const { return m_oHeader.nRecNum; }
+    inline size_t GetRecLen() const { return m_oHeader.nRecLen; }
+    inline const TDbfHeader& GetHeader() const { return m_oHeader; }
+    std::vector<TDbfField> GetField() const { return m_vecField; }
+
+    // ȡ[nRecNo, nRecNo + nRecNum)ļ¼뷶ΧȡβĲֲһ
+    int Read(size_t nRecNo, size_t nRecNum)
+    {
+        if (!IsOpen() || nRecNo > GetRecNum() || nRecNum > GetRecNum() - nRecNo)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        m_nRecNum = 0;
+        if (nRecNum == 0)
+        {
+            return CIDbf::DBF_SUCC;
+        }
+        unsigned long long nOffset = m_nRecordOffset + (unsigned long long)nRecNo * GetRecLen();
+        m_pData = ReadRange(nOffset, nRecNum * GetRecLen());
+        if (!m_pData)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        DropCache(nOffset, nRecNum * GetRecLen());
+        m_nRecNum = nRecNum;
+        return CIDbf::DBF_SUCC;
+    }
+    // һReadеĵnRec¼
+    inline const char* ReadData(size_t nRec = 0) const
+    {
+        assert(nRec < m_nRecNum);
+        return m_pData + nRec * GetRecLen();
+    }
+
+    // ˳ɨȫ¼ÿm_nBatchRecs(Ϊ0ʱm_nBatchSizeֽڼ)
+    int Scan(const TCallback& fnCallback)
+    {
+        if (!IsOpen())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nBatch = m_nBatchRecs ? m_nBatchRecs : MMax(m_nBatchSize / GetRecLen(), (size_t)1);
+        for (size_t nRecNo = 0; nRecNo < GetRecNum(); nRecNo += nBatch)
+        {
+            size_t nNum = MMin(nBatch, GetRecNum() - nRecNo);
+            int nRet = Read(nRecNo, nNum);
+            if (nRet)
+            {
+                return nRet;
+            }
+            if (fnCallback(m_pData, nRecNo, nNum))
+            {
+                break;
+            }
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+public:
+    // ǷO_DIRECT
+    bool m_bDirect;
+    // ͨȡʱǷڶȡҳ
+    bool m_bDropCache;
+    // Scanÿļ¼Ϊ0ʱm_nBatchSize
+    size_t m_nBatchRecs;
+    // Scanÿֽ
+    size_t m_nBatchSize;
+
+private:
+    CDbfDirectScan(const CDbfDirectScan&);
+    CDbfDirectScan& operator=(const CDbfDirectScan&);
+
+    // ȡ[nOffset, nOffset + nSize)ظ÷ΧڻеʼλãȡʱNULL
+    // 벢ãֻڲʱ
+    const char* ReadRange(unsigned long long nOffset, size_t nSize)
+    {
+        unsigned long long nStart = nOffset & ~(unsigned long long)(ALIGN_SIZE - 1);
+        // Ķȡ
+        size_t nLen = (size_t)(((nOffset + nSize + ALIGN_SIZE - 1) & ~(unsigned long long)(ALIGN_SIZE - 1)) - nStart);
+        if (nLen > m_nBufSize)
+        {
+            FreeBuf();
+            size_t nBufSize = ALIGN_SIZE;
+            while (nBufSize < nLen)
+            {
+                nBufSize <<= 1;
+            }
+            if (AllocBuf(nBufSize))
+            {
+                return NULL;
+            }
+        }
+        size_t nWant = (size_t)(nOffset - nStart) + nSize;
+        size_t nDone = 0;
+        while (nDone < nWant)
+        {
+#ifndef _WIN32
+            // ֱӶȡʱ룬ļĩβʵʳ
+            ssize_t nRead = pread(m_nFd, m_pBuf + nDone, nLen - nDone, (off_t)(nStart + nDone));
+            if (nRead < 0 && errno == EINTR)
+            {
+                continue;
+            }
+#else
+            long long nRead = (long long)m_oFile.ReadAt(nStart + nDone, m_pBuf + nDone, nLen - nDone);
+#endif
+            if (nRead <= 0)
+            {
+                return NULL;
+            }
+            nDone += nRead;
+        }
+        return m_pBuf + (size_t)(nOffset - nStart);
+    }
+
+    // ͨȡʱѶΧҳ棬󵽶߽磬βҳᱣ
+    void DropCache(unsigned long long nOffset, size_t nSize)
+    {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+        if (!m_bIsDirect && m_bDropCache)
+        {
+            unsigned long long nStart = nOffset & ~(unsigned long long)(ALIGN_SIZE - 1);
+            unsigned long long nEnd = (nOffset + nSize + ALIGN_SIZE - 1) & ~(unsigned long long)(ALIGN_SIZE - 1);
+            posix_fadvise(m_nFd, (off_t)nStart, (off_t)(nEnd - nStart), POSIX_FADV_DONTNEED);
+        }
+#else
+        (void)nOffset;
+        (void)nSize;
+#endif
+    }
+
+    int AllocBuf(size_t nSize)
+    {
+#ifdef _WIN32
+        m_pBuf = (char*)_aligned_malloc(nSize, ALIGN_SIZE);
+#else
+        void* p = NULL;
+        m_pBuf = posix_memalign(&p, ALIGN_SIZE, nSize) == 0 ? (char*)p : NULL;
+#endif
+        m_nBufSize = m_pBuf ? nSize : 0;
+        return m_pBuf ? CIDbf::DBF_SUCC : CIDbf::DBF_CACHE_ERROR;
+    }
+    void FreeBuf()
+    {
+#ifdef _WIN32
+        _aligned_free(m_pBuf);
+#else
+        free(m_pBuf);
+#endif
+        m_pBuf = NULL;
+        m_nBufSize = 0;
+        m_pData = NULL;
+        m_nRecNum = 0;
+    }
+
+private:
+    int m_nFd;
+#ifdef _WIN32
+    CDbfStdioFile m_oFile;
+#endif
+    bool m_bIsDirect;
+    TDbfHeader m_oHeader;
+    std::vector<TDbfField> m_vecField;
+    // ¼ʼƫƣһ㲻
+    size_t m_nRecordOffset;
+    // Ķ
+    char* m_pBuf;
+    size_t m_nBufSize;
+    // һReadļ¼
+    const char* m_pData;
+    size_t m_nRecNum;
+};
+
+#endif
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_FOLLOW_H__
+#define __P_DBF_FOLLOW_H__
+#include <chrono>
+#include <thread>
+#include "PDbf.h"
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+// ֻ׷ӵDBFļ(tail -f)
+// ļ仯ʱֻ¶ȡļͷ¼ȡ׷ӵļ¼´ļͽֶ
+// Linuxʹinotifyȴļ仯ƽ̨inotifyʱm_nPollMsѯ
+class CDbfFollower
+{
+public:
+    CDbfFollower()
+    {
+        m_nLast = 0;
+        m_nMaxBatch = 10000;
+        m_nPollMs = 100;
+        m_nNotify = -1;
+        m_nWatch = -1;
+    }
+    ~CDbfFollower()
+    {
+        Close();
+    }
+public:
+    // ÿηص¼
+    size_t m_nMaxBatch;
+    // ()inotifyʧ¼ʱҲڸʱڷ¼¼
+    int m_nPollMs;
+
+    // ļbFromStartΪfalseʱӵǰļĩβʼ
+    int Open(const std::string& strFile, bool bFromStart = false)
+    {
+        Close();
+        if (m_oDbf.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_nLast = bFromStart ? 0 : m_oDbf.GetRecNum();
+#ifdef __linux__
+        m_nNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_nNotify >= 0)
+        {
+            m_nWatch = inotify_add_watch(m_nNotify, strFile.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+            if (m_nWatch < 0)
+            {
+                close(m_nNotify);
+                m_nNotify = -1;
+            }
+        }
+#endif
+        return CIDbf::DBF_SUCC;
+    }
+
+    void Close()
+    {
+#ifdef __linux__
+        if (m_nNotify >= 0)
+        {
+            close(m_nNotify);
+        }
+#endif
+        m_nNotify = -1;
+        m_nWatch = -1;
+        m_oDbf.Close();
+    }
+
+    // ȴ׷ӵļ¼ȴnTimeoutMs(С0ʱһֱȴ)
+    // ¼¼ʱ뻺棬nRecNoΪһ¼ļ¼ţnNumΪ¼
+    // ֮ͨDbf().ReadGo(0..nNum-1)ȡʱʱnNumΪ0DBF_SUCC
+    // ļضϡ滻ɾʱDBF_FILE_ERRORҪ´
+    int Next(size_t& nRecNo, size_t& nNum, int nTimeoutMs = -1)
+    {
+        nRecNo = m_nLast;
+        nNum = 0;
+        if (!m_oDbf.IsOpen())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        std::chrono::steady_clock::time_point tEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(MMax(nTimeoutMs, 0));
+        while (true)
+        {
+            int nRet = m_oDbf.RefreshHeader();
+            if (nRet)
+            {
+                return nRet;
+            }
+            size_t nRecNum = m_oDbf.GetRecNum();
+            if (nRecNum < m_nLast)
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            if (nRecNum > m_nLast)
+            {
+                nNum = MMin(nRecNum - m_nLast, MMax(m_nMaxBatch, (size_t)1));
+                if (m_oDbf.Read(m_nLast, nNum))
+                {
+                    nNum = 0;
+                    return CIDbf::DBF_ERROR;
+                }
+                m_nLast += nNum;
+                return CIDbf::DBF_SUCC;
+            }
+
+            // 㱾εȴʱ
+            int nWait = m_nPollMs;
+            if (nTimeoutMs >= 0)
+            {
+                long long nLeft = std::chrono::duration_cast<std::chrono::milliseconds>(tEnd - std::chrono::steady_clock::now()).count();
+                if (nLeft <= 0)
+                {
+                    return CIDbf::DBF_SUCC;
+                }
+                nWait = (int)MMin((long long)nWait, nLeft);
+            }
+            if (Wait(nWait))
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+        }
+    }
+
+    // ѽļ¼һηصʼ¼
+    inline size_t GetPos() const { return m_nLast; }
+    // ٵļڶȡNextصĻ¼
+    inline CPDbf& Dbf() { return m_oDbf; }
+
+private:
+    // ȴļ仯ʱļɾ滻ʱط0
+    int Wait(int nWaitMs)
+    {
+#ifdef __linux__
+        if (m_nNotify >= 0)
+        {
+            struct pollfd oPoll;
+            oPoll.fd = m_nNotify;
+            oPoll.events = POLLIN;
+            oPoll.revents = 0;
+            if (poll(&oPoll, 1, nWaitMs) > 0)
+            {
+                // ȡ¼
+                char szBuf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+                ssize_t nLen = 0;
+                int nRet = CIDbf::DBF_SUCC;
+                while ((nLen = read(m_nNotify, szBuf, sizeof(szBuf))) > 0)
+                {
+                    for (char* p = szBuf; p < szBuf + nLen; )
+                    {
+                        struct inotify_event* pEvent = (struct inotify_event*)p;
+                        if (pEvent->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+                        {
+                            nRet = CIDbf::DBF_FILE_ERROR;
+                        }
+                        p += sizeof(struct inotify_event) + pEvent->len;
+                    }
+                }
+                return nRet;
+            }
+            return CIDbf::DBF_SUCC;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(nWaitMs));
+        return CIDbf::DBF_SUCC;
+    }
+
+private:
+    // ٵļ
+    CPDbf m_oDbf;
+    // ѽļ¼
+    size_t m_nLast;
+    // inotify
+    int m_nNotify;
+    // inotifyӾ
+    int m_nWatch;
+};
+
+#endif
@@ -0,0 +1,446 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_JOIN_H__
+#define __P_DBF_JOIN_H__
+#include <functional>
+#include <thread>
+#include "PDbf.h"
+#include "PDbfAggregate.h"
+
+// ӽֶ
+class TDbfJoinField
+{
+public:
+    // trueȡԹfalseȡ̽
+    bool bBuild;
+    // Դֶ
+    std::string strField;
+    // ֶΪʱԴֶͬ
+    std::string strName;
+
+    TDbfJoinField(bool bFromBuild = false, const std::string& strSrcField = "", const std::string& strOutName = "")
+    {
+        bBuild = bFromBuild;
+        strField = strSrcField;
+        strName = strOutName;
+    }
+};
+
+// ϣ
+// (ͨΪСĲο֤ȯϢ)ڴ棬ԭʼֽڽϣ
+// ̽(ɽ)ȡÿָ̲߳̽⣬̽˳DBFص
+// ڴռΪСÿ
+// ʱ̽ԶĽɫʱС˳
+// ɾ־Ϊ'*'ļ¼
+class CDbfJoin
+{
+public:
+    // صpRowsΪnNumĽ¼(ʽGetField()һ)ط0ʱֹͣ
+    typedef std::function<int(const char* pRows, size_t nNum, size_t nRecLen)> TCallback;
+
+    CDbfJoin()
+    {
+        m_nThreadNum = MMax(std::thread::hardware_concurrency(), 1U);
+        m_nBatchRecs = 64 * 1024;
+        m_bLeftJoin = false;
+        m_nJoinRecs = 0;
+        m_nRecLen = 0;
+        m_nKeyLen = 0;
+        m_bSwap = false;
+    }
+
+    // ֶͬ
+    int Join(const std::string& strBuild, const std::string& strProbe, const std::vector<std::string>& vecKey,
+        const std::vector<TDbfJoinField>& vecOut, const std::string& strOutFile)
+    {
+        return Join(strBuild, strProbe, vecKey, vecKey, vecOut, strOutFile);
+    }
+    // дstrOutFile
+    int Join(const std::string& strBuild, const std::string& strProbe, const std::vector<std::string>& vecBuildKey,
+        const std::vector<std::string>& vecProbeKey, const std::vector<TDbfJoinField>& vecOut, const std::string& strOutFile)
+    {
+        CPDbf oOut;
+        int nRet = CIDbf::DBF_SUCC;
+        bool bCreate = false;
+        TCallback fnWrite = [&](const char* pRows, size_t nNum, size_t) -> int
+        {
+            return oOut.WriteRecord(oOut.GetRecNum(), pRows, nNum);
+        };
+        nRet = Prepare(strBuild, strProbe, vecBuildKey, vecProbeKey, vecOut);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            std::vector<TDbfField> vecField = GetField();
+            bCreate = true;
+            nRet = oOut.Create(strOutFile, vecField) ? CIDbf::DBF_FILE_ERROR : Probe(fnWrite);
+        }
+        if (bCreate && nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = oOut.FileCommit();
+        }
+        return nRet;
+    }
+    // ص
+    int Join(const std::string& strBuild, const std::string& strProbe, const std::vector<std::string>& vecBuildKey,
+        const std::vector<std::string>& vecProbeKey, const std::vector<TDbfJoinField>& vecOut, TCallback fnCallback)
+    {
+        int nRet = Prepare(strBuild, strProbe, vecBuildKey, vecProbeKey, vecOut);
+        return nRet ? nRet : Probe(fnCallback);
+    }
+
+    // ֶζ
+    inline const std::vector<TDbfField>& GetField() const { return m_vecOutField; }
+    // ¼
+    inline size_t GetRecLen() const { return m_nRecLen; }
+
+public:
+    // ̽߳
+    unsigned int m_nThreadNum;
+    // ̽ÿȡļ¼
+    size_t m_nBatchRecs;
+    // ӣ̽ûƥļ¼ҲֶΪ
+    bool m_bLeftJoin;
+    // ϴļ¼
+    size_t m_nJoinRecs;
+
+private:
+    // ļֶμ
+    class TSide
+    {
+    public:
+        std::string strFile;
+        std::vector<TDbfField> vecField;
+        std::vector<size_t> vecKeyPos;
+        size_t nRecLen;
+        size_t nRecNum;
+    };
+    // ֶεĿλ
+    class TCopy
+    {
+    public:
+        bool bBuild;
+        size_t nSrc;
+        size_t nDst;
+        size_t nLen;
+    };
+
+    static int OpenSide(const std::string& strFile, const std::vector<std::string>& vecKey, TSide& oSide)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(strFile))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        oSide.strFile = strFile;
+        oSide.vecField = oDbf.GetField();
+        oSide.nRecLen = oDbf.GetRecLen();
+        oSide.nRecNum = oDbf.GetRecNum();
+        oSide.vecKeyPos.clear();
+        for (size_t i = 0; i < vecKey.size(); i++)
+        {
+            size_t nIdx = CPDbf::FindField(oSide.vecField, vecKey[i]);
+            if (nIdx == oSide.vecField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            oSide.vecKeyPos.push_back(nIdx);
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ֶΣ빹ϣ
+    int Prepare(const std::string& strBuild, const std::string& strProbe, const std::vector<std::string>& vecBuildKey,
+        const std::vector<std::string>& vecProbeKey, const std::vector<TDbfJoinField>& vecOut)
+    {
+        m_nJoinRecs = 0;
+        if (vecBuildKey.empty() || vecBuildKey.size() != vecProbeKey.size() || vecOut.empty())
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        int nRet = OpenSide(strBuild, vecBuildKey, m_oBuild);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = OpenSide(strProbe, vecProbeKey, m_oProbe);
+        }
+        if (nRet)
+        {
+            return nRet;
+        }
+        // ʱýСıϣ
+        m_bSwap = !m_bLeftJoin && m_oBuild.nRecNum * m_oBuild.nRecLen > m_oProbe.nRecNum * m_oProbe.nRecLen;
+        if (m_bSwap)
+        {
+            std::swap(m_oBuild, m_oProbe);
+        }
+
+        // ַȲͬʱϳĲոֵҶ룬߶ֵʱΪֵȽϣ
+        // ȡСλͬҲƥ䣬ֵ0ͬ
+        m_vecKeyLen.clear();
+        m_vecKeyNum.clear();
+        m_nKeyLen = 0;
+        for (size_t i = 0; i < m_oBuild.vecKeyPos.size(); i++)
+        {
+            const TDbfField& oBuild = m_oBuild.vecField[m_oBuild.vecKeyPos[i]];
+            const TDbfField& oProbe = m_oProbe.vecField[m_oProbe.vecKeyPos[i]];
+            bool bNum = (oBuild.cType == 'N' || oBuild.cType == 'F') && (oProbe.cType == 'N' || oProbe.cType == 'F');
+            size_t nLen = bNum ? 1 + sizeof(double) : MMax(oBuild.cLength, oProbe.cLength);
+            m_vecKeyLen.push_back(nLen);
+            m_vecKeyNum.push_back(bNum);
+            m_nKeyLen += nLen;
+        }
+
+        // ֶ
+        m_vecOutField.clear();
+        m_vecCopy.clear();
+        m_nRecLen = 1;
+        for (size_t i = 0; i < vecOut.size(); i++)
+        {
+            bool bBuild = vecOut[i].bBuild != m_bSwap;
+            const TSide& oSide = bBuild ? m_oBuild : m_oProbe;
+            size_t nIdx = CPDbf::FindField(oSide.vecField, vecOut[i].strField);
+            if (nIdx == oSide.vecField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            TDbfField oField = oSide.vecField[nIdx];
+            if (!vecOut[i].strName.empty())
+            {
+                memset(oField.szName, 0, sizeof(oField.szName));
+                strncpy(oField.szName, vecOut[i].strName.c_str(), sizeof(oField.szName) - 1);
+            }
+            TCopy oCopy;
+            oCopy.bBuild = bBuild;
+            oCopy.nSrc = oField.nPosition;
+            oCopy.nDst = m_nRecLen;
+            oCopy.nLen = oField.cLength;
+            oField.nPosition = (unsigned short)m_nRecLen;
+            m_nRecLen += oField.cLength;
+            m_vecOutField.push_back(oField);
+            m_vecCopy.push_back(oCopy);
+        }
+
+        // ֱӶ빹棬ɾļ¼ѹnBuildNumΪЧ¼
+        CPDbf oDbf;
+        if (oDbf.Open(m_oBuild.strFile))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nRecLen = m_oBuild.nRecLen;
+        size_t nBuildNum = 0;
+        m_vecBuild.resize(m_oBuild.nRecNum * nRecLen);
+        const size_t nBatch = MMax(m_nBatchRecs, (size_t)1);
+        for (size_t nRecNo = 0; nRecNo < m_oBuild.nRecNum; nRecNo += nBatch)
+        {
+            size_t nNum = MMin(nBatch, m_oBuild.nRecNum - nRecNo);
+            char* pData = &m_vecBuild[nBuildNum * nRecLen];
+            if (oDbf.ReadRecord(nRecNo, pData, nNum))
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            for (size_t i = 0; i < nNum; i++)
+            {
+                const char* pRec = pData + i * nRecLen;
+                if (*pRec == '*')
+                {
+                    continue;
+                }
+                char* pDst = &m_vecBuild[nBuildNum * nRecLen];
+                if (pDst != pRec)
+                {
+                    memcpy(pDst, pRec, nRecLen);
+                }
+                nBuildNum++;
+            }
+        }
+        m_vecBuild.resize(nBuildNum * nRecLen);
+        oDbf.Close();
+
+        // ϣͬļ¼ԭ˳򴮳
+        m_oTable.Init(m_nKeyLen);
+        m_vecHead.clear();
+        m_vecTail.clear();
+        m_vecNext.assign(nBuildNum, (size_t)-1);
+        std::vector<char> vecKey(m_nKeyLen + 1);
+        for (size_t i = 0; i < nBuildNum; i++)
+        {
+            MakeKey(m_oBuild, &m_vecBuild[i * nRecLen], &vecKey[0]);
+            bool bNew = false;
+            size_t nIdx = m_oTable.Insert(&vecKey[0], bNew);
+            if (bNew)
+            {
+                m_vecHead.push_back(i);
+                m_vecTail.push_back(i);
+            }
+            else
+            {
+                m_vecNext[m_vecTail[nIdx]] = i;
+                m_vecTail[nIdx] = i;
+            }
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    void MakeKey(const TSide& oSide, const char* pRec, char* pKey) const
+    {
+        for (size_t i = 0; i < oSide.vecKeyPos.size(); i++)
+        {
+            const TDbfField& oField = oSide.vecField[oSide.vecKeyPos[i]];
+            const char* pField = pRec + oField.nPosition;
+            if (m_vecKeyNum[i])
+            {
+                // ־ֵֽֿ+0.0-0.0ͳһΪ+0.0
+                size_t nPos = 0;
+                while (nPos < oField.cLength && pField[nPos] == ' ')
+                {
+                    nPos++;
+                }
+                double fValue = CDbfFastParse::ToDouble(pField, oField.cLength) + 0.0;
+                pKey[0] = nPos < oField.cLength ? '1' : '0';
+                memcpy(pKey + 1, &fValue, sizeof(fValue));
+            }
+            else
+            {
+                memcpy(pKey, pField, oField.cLength);
+                memset(pKey + oField.cLength, ' ', m_vecKeyLen[i] - oField.cLength);
+            }
+            pKey += m_vecKeyLen[i];
+        }
+    }
+
+    // ȡ̽̽
+    int Probe(TCallback& fnCallback)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(m_oProbe.strFile))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nThread = MMax((size_t)m_nThreadNum, (size_t)1);
+        std::vector<std::vector<char> > vecOut(nThread);
+        std::vector<size_t> vecNum(nThread);
+        const size_t nBatch = MMax(m_nBatchRecs, (size_t)1);
+        for (size_t nRecNo = 0; nRecNo < m_oProbe.nRecNum; nRecNo += nBatch)
+        {
+            size_t nNum = MMin(nBatch, m_oProbe.nRecNum - nRecNo);
+            if (oDbf.Read(nRecNo, nNum))
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            const char* pData = oDbf.ReadData(0);
+            size_t nStep = (nNum + nThread - 1) / nThread;
+            std::vector<std::thread> vecThread;
+            for (size_t t = 0; t < nThread && t * nStep < nNum; t++)
+            {
+                size_t nCount = MMin(nStep, nNum - t * nStep);
+                vecThread.push_back(std::thread(&CDbfJoin::ProbeRange, this, pData + t * nStep * m_oProbe.nRecLen,
+                    nCount, &vecOut[t], &vecNum[t]));
+            }
+            for (size_t t = 0; t < vecThread.size(); t++)
+            {
+                vecThread[t].join();
+            }
+            // ̽˳
+            for (size_t t = 0; t < vecThread.size(); t++)
+            {
+                if (vecNum[t] && fnCallback(&vecOut[t][0], vecNum[t], m_nRecLen))
+                {
+                    return CIDbf::DBF_ERROR;
+                }
+                m_nJoinRecs += vecNum[t];
+            }
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ̽һμ¼дvecOut
+    void ProbeRange(const char* pData, size_t nNum, std::vector<char>* pOut, size_t* pOutNum) const
+    {
+        std::vector<char> vecKey(m_nKeyLen + 1);
+        std::vector<char>& vecOut = *pOut;
+        size_t nOut = 0;
+        for (size_t i = 0; i < nNum; i++)
+        {
+            const char* pProbe = pData + i * m_oProbe.nRecLen;
+            if (*pProbe == '*')
+            {
+                continue;
+            }
+            MakeKey(m_oProbe, pProbe, &vecKey[0]);
+            size_t nIdx = m_oTable.Find(&vecKey[0]);
+            size_t nBuild = nIdx == CDbfKeyTable::npos ? (size_t)-1 : m_vecHead[nIdx];
+            if (nBuild == (size_t)-1 && !m_bLeftJoin)
+            {
+                continue;
+            }
+            do
+            {
+                if ((nOut + 1) * m_nRecLen > vecOut.size())
+                {
+                    vecOut.resize(MMax(vecOut.size() * 2, (nOut + 1) * m_nRecLen));
+                }
+                char* pRow = &vecOut[nOut * m_nRecLen];
+                const char* pBuild = nBuild == (size_t)-1 ? NULL : &m_vecBuild[nBuild * m_oBuild.nRecLen];
+                pRow[0] = ' ';
+                for (size_t k = 0; k < m_vecCopy.size(); k++)
+                {
+                    const TCopy& oCopy = m_vecCopy[k];
+                    const char* pSrc = oCopy.bBuild ? pBuild : pProbe;
+                    if (pSrc)
+                    {
+                        memcpy(pRow + oCopy.nDst, pSrc + oCopy.nSrc, oCopy.nLen);
+                    }
+                    else
+                    {
+                        memset(pRow + oCopy.nDst, ' ', oCopy.nLen);
+                    }
+                }
+                nOut++;
+                nBuild = nBuild == (size_t)-1 ? (size_t)-1 : m_vecNext[nBuild];
+            } while (nBuild != (size_t)-1);
+        }
+        *pOutNum = nOut;
+    }
+
+private:
+    TSide m_oBuild;
+    TSide m_oProbe;
+    // Ƿ񽻻˹̽
+    bool m_bSwap;
+    // ֶγȡǷֵȽϣܳ
+    std::vector<size_t> m_vecKeyLen;
+    std::vector<bool> m_vecKeyNum;
+    size_t m_nKeyLen;
+    // ֶ
+    std::vector<TDbfField> m_vecOutField;
+    std::vector<TCopy> m_vecCopy;
+    size_t m_nRecLen;
+    // ݼϣ
+    std::vector<char> m_vecBuild;
+    CDbfKeyTable m_oTable;
+    // ÿĩ¼¼һͬ¼
+    std::vector<size_t> m_vecHead;
+    std::vector<size_t> m_vecTail;
+    std::vector<size_t> m_vecNext;
+};
+
+#endif
@@ -0,0 +1,624 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_LOADER_H__
+#define __P_DBF_LOADER_H__
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include "PDbf.h"
+
+// Linux 5.6ںͷļṩio_uringOPENAT/READ/CLOSEʱãֱʹϵͳãliburing
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// linux/io_uring.hlinux/fs.hBLOCK_SIZE꣬ƻͷļ(concurrentqueue.h)еͬ
+#undef BLOCK_SIZE
+#undef BLOCK_SIZE_BITS
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <stdint.h>
+#ifdef IORING_FEAT_CUR_PERSONALITY
+#define PDBF_IO_URING
+#endif
+#endif
+#endif
+
+#ifdef PDBF_IO_URING
+// io_uringύɶеСװ߳ʹ
+class CDbfUring
+{
+public:
+    CDbfUring()
+    {
+        m_nFd = -1;
+        m_pSqRing = MAP_FAILED;
+        m_pCqRing = MAP_FAILED;
+        m_pSqe = (io_uring_sqe*)MAP_FAILED;
+        m_nSqRingSize = 0;
+        m_nCqRingSize = 0;
+        m_nSqeSize = 0;
+        m_nPending = 0;
+        m_nCompleted = 0;
+    }
+    ~CDbfUring()
+    {
+        Close();
+    }
+
+    // Уں˲ֻ֧򱻽ֹʱDBF_ERROR
+    int Init(unsigned int nEntries)
+    {
+        io_uring_params oParam;
+        memset(&oParam, 0, sizeof(oParam));
+        m_nFd = (int)syscall(__NR_io_uring_setup, nEntries, &oParam);
+        if (m_nFd < 0)
+        {
+            return CIDbf::DBF_ERROR;
+        }
+        m_nSqRingSize = oParam.sq_off.array + oParam.sq_entries * sizeof(unsigned int);
+        m_nCqRingSize = oParam.cq_off.cqes + oParam.cq_entries * sizeof(io_uring_cqe);
+        bool bSingle = (oParam.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (bSingle)
+        {
+            m_nSqRingSize = m_nCqRingSize = MMax(m_nSqRingSize, m_nCqRingSize);
+        }
+        m_pSqRing = mmap(NULL, m_nSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_nFd, IORING_OFF_SQ_RING);
+        m_pCqRing = bSingle || m_pSqRing == MAP_FAILED ? m_pSqRing
+            : mmap(NULL, m_nCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_nFd, IORING_OFF_CQ_RING);
+        m_nSqeSize = oParam.sq_entries * sizeof(io_uring_sqe);
+        m_pSqe = (io_uring_sqe*)mmap(NULL, m_nSqeSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_nFd, IORING_OFF_SQES);
+        if (m_pSqRing == MAP_FAILED || m_pCqRing == MAP_FAILED || m_pSqe == MAP_FAILED)
+        {
+            Close();
+            return CIDbf::DBF_ERROR;
+        }
+        char* pSq = (char*)m_pSqRing;
+        char* pCq = (char*)m_pCqRing;
+        m_pSqHead = (unsigned int*)(pSq + oParam.sq_off.head);
+        m_pSqTail = (unsigned int*)(pSq + oParam.sq_off.tail);
+        m_nSqMask = *(unsigned int*)(pSq + oParam.sq_off.ring_mask);
+        m_nSqEntries = oParam.sq_entries;
+        m_pSqArray = (unsigned int*)(pSq + oParam.sq_off.array);
+        m_pCqHead = (unsigned int*)(pCq + oParam.cq_off.head);
+        m_pCqTail = (unsigned int*)(pCq + oParam.cq_off.tail);
+        m_nCqMask = *(unsigned int*)(pCq + oParam.cq_off.ring_mask);
+        m_pCqe = (io_uring_cqe*)(pCq + oParam.cq_off.cqes);
+        return CIDbf::DBF_SUCC;
+    }
+    void Close()
+    {
+        if (m_pSqe != MAP_FAILED)
+        {
+            munmap(m_pSqe, m_nSqeSize);
+        }
+        if (m_pCqRing != MAP_FAILED && m_pCqRing != m_pSqRing)
+        {
+            munmap(m_pCqRing, m_nCqRingSize);
+        }
+        if (m_pSqRing != MAP_FAILED)
+        {
+            munmap(m_pSqRing, m_nSqRingSize);
+        }
+        if (m_nFd >= 0)
+        {
+            close(m_nFd);
+        }
+        m_nFd = -1;
+        m_pSqRing = MAP_FAILED;
+        m_pCqRing = MAP_FAILED;
+        m_pSqe = (io_uring_sqe*)MAP_FAILED;
+        m_nPending = 0;
+        m_nCompleted = 0;
+    }
+
+    // ȡһеύʱNULL
+    io_uring_sqe* GetSqe()
+    {
+        unsigned int nHead = __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE);
+        unsigned int nTail = *m_pSqTail + m_nPending;
+        if (nTail - nHead >= m_nSqEntries)
+        {
+            return NULL;
+        }
+        unsigned int nIdx = nTail & m_nSqMask;
+        io_uring_sqe* pSqe = &m_pSqe[nIdx];
+        memset(pSqe, 0, sizeof(*pSqe));
+        m_pSqArray[nIdx] = nIdx;
+        m_nPending++;
+        return pSqe;
+    }
+    // ύдύȴnWait
+    int Submit(unsigned int nWait)
+    {
+        __atomic_store_n(m_pSqTail, *m_pSqTail + m_nPending, __ATOMIC_RELEASE);
+        unsigned int nSubmit = m_nPending;
+        m_nPending = 0;
+        while (true)
+        {
+            long nRet = syscall(__NR_io_uring_enter, m_nFd, nSubmit, nWait, nWait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+            if (nRet >= 0)
+            {
+                return CIDbf::DBF_SUCC;
+            }
+            if (errno != EINTR)
+            {
+                return CIDbf::DBF_ERROR;
+            }
+            nSubmit = 0;
+        }
+    }
+    // ȡһûʱfalse
+    bool PopCqe(unsigned long long& nUserData, int& nRes)
+    {
+        unsigned int nHead = *m_pCqHead;
+        if (nHead == __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE))
+        {
+            return false;
+        }
+        const io_uring_cqe& oCqe = m_pCqe[nHead & m_nCqMask];
+        nUserData = oCqe.user_data;
+        nRes = oCqe.res;
+        __atomic_store_n(m_pCqHead, nHead + 1, __ATOMIC_RELEASE);
+        m_nCompleted++;
+        return true;
+    }
+    // ȡѷύеںδȡߵύûʱfalse
+    bool Unqueue(io_uring_sqe& oSqe)
+    {
+        unsigned int nTail = *m_pSqTail;
+        if (nTail == __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE))
+        {
+            return false;
+        }
+        nTail--;
+        oSqe = m_pSqe[m_pSqArray[nTail & m_nSqMask]];
+        __atomic_store_n(m_pSqTail, nTail, __ATOMIC_RELEASE);
+        return true;
+    }
+    // ںȡߵδȡĲ
+    unsigned int Inflight() const
+    {
+        return __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE) - m_nCompleted;
+    }
+    // ֻȴһɣύ
+    int Wait()
+    {
+        while (syscall(__NR_io_uring_enter, m_nFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0)
+        {
+            if (errno != EINTR)
+            {
+                return CIDbf::DBF_ERROR;
+            }
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+private:
+    CDbfUring(const CDbfUring&);
+    CDbfUring& operator=(const CDbfUring&);
+
+    int m_nFd;
+    void* m_pSqRing;
+    void* m_pCqRing;
+    io_uring_sqe* m_pSqe;
+    size_t m_nSqRingSize;
+    size_t m_nCqRingSize;
+    size_t m_nSqeSize;
+    unsigned int* m_pSqHead;
+    unsigned int* m_pSqTail;
+    unsigned int* m_pSqArray;
+    unsigned int m_nSqMask;
+    unsigned int m_nSqEntries;
+    unsigned int* m_pCqHead;
+    unsigned int* m_pCqTail;
+    unsigned int m_nCqMask;
+    io_uring_cqe* m_pCqe;
+    // дδύύ
+    unsigned int m_nPending;
+    // ȡ
+    unsigned int m_nCompleted;
+};
+#endif
+
+// شDBFļ
+// ÿļڴڴģʽ򿪣صLinuxͨio_uringύ򿪡ȡļͷֶΡ
+// ȡ¼͹رղͬʱеļΪm_nQueueDepthio_uringʱ̳߳ذpreadȡ
+// صڵLoadִ߳
+class CDbfLoader
+{
+public:
+    // nIndexΪļбеţnRetΪDBF_SUCCʱoDbfΪڴģʽ򿪵ıصغر
+    typedef std::function<void(size_t nIndex, const std::string& strFile, int nRet, CPDbf& oDbf)> TCallback;
+
+    CDbfLoader()
+    {
+        m_nQueueDepth = 256;
+        m_nThreadNum = MMax(std::thread::hardware_concurrency(), 1U);
+        m_nProbeSize = 8 * 1024;
+        m_bUseUring = true;
+        m_bUringUsed = false;
+    }
+
+    // ȫļȫɹʱDBF_SUCC򷵻DBF_FILE_ERRORļĽص
+    int Load(const std::vector<std::string>& vecFile, const TCallback& fnCallback)
+    {
+        m_bUringUsed = false;
+        m_nFailNum = 0;
+        std::vector<size_t> vecLeft;
+#ifdef PDBF_IO_URING
+        if (m_bUseUring && LoadUring(vecFile, fnCallback, vecLeft) == CIDbf::DBF_SUCC)
+        {
+            m_bUringUsed = true;
+        }
+        else
+#endif
+        {
+            vecLeft.clear();
+            for (size_t i = 0; i < vecFile.size(); i++)
+            {
+                vecLeft.push_back(i);
+            }
+        }
+        // io_uringûֵ֧ļ̳߳ضȡ
+        if (!vecLeft.empty())
+        {
+            LoadPread(vecFile, vecLeft, fnCallback);
+        }
+        return m_nFailNum ? CIDbf::DBF_FILE_ERROR : CIDbf::DBF_SUCC;
+    }
+
+    // һLoadǷʹio_uring
+    inline bool IsUringUsed() const { return m_bUringUsed; }
+
+    // ȡļӳȶm_nProbeSizeֽڣļͷ¼С󲹶ʣಿ
+    static int ReadImage(const std::string& strFile, size_t nProbeSize, std::vector<char>& vecImage)
+    {
+        CDbfPreadFile oFile;
+        if (oFile.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        vecImage.resize(MMax(nProbeSize, sizeof(TDbfHeader)));
+        size_t nDone = oFile.ReadAt(0, &vecImage[0], vecImage.size());
+        size_t nExpect = ImageSize(vecImage, nDone);
+        if (nExpect == 0)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        vecImage.resize(nExpect);
+        if (nDone < nExpect)
+        {
+            nDone += oFile.ReadAt(nDone, &vecImage[nDone], nExpect - nDone);
+            vecImage.resize(nDone);
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+public:
+    // ͬʱеļio_uring
+    size_t m_nQueueDepth;
+    // io_uringʱĶȡ߳
+    size_t m_nThreadNum;
+    // ״ζȡֽСļһζ
+    size_t m_nProbeSize;
+    // Ƿʹio_uring
+    bool m_bUseUring;
+
+private:
+    // ļͷӳС(־)Ѷݲļͷӳ񳬳ַռʱ0
+    static size_t ImageSize(const std::vector<char>& vecImage, size_t nDone)
+    {
+        if (nDone < sizeof(TDbfHeader))
+        {
+            return 0;
+        }
+        const TDbfHeader* pHeader = (const TDbfHeader*)&vecImage[0];
+        if (pHeader->nHeaderLen <= sizeof(TDbfHeader))
+        {
+            return 0;
+        }
+        unsigned long long nSize = pHeader->nHeaderLen + CPDbf::GetRemarkSize(pHeader->cVer)
+            + (unsigned long long)pHeader->nRecNum * pHeader->nRecLen + 1;
+        return nSize > vecImage.max_size() ? 0 : (size_t)nSize;
+    }
+
+    // ڴģʽӳ񲢻ص
+    void Deliver(size_t nIndex, const std::string& strFile, int nRet, std::vector<char>& vecImage, const TCallback& fnCallback)
+    {
+        CPDbf oDbf;
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = oDbf.OpenInMemory(strFile, vecImage);
+        }
+        if (nRet)
+        {
+            m_nFailNum++;
+        }
+        fnCallback(nIndex, strFile, nRet, oDbf);
+    }
+
+    // ̳߳ضȡļУɵ̻߳ص
+    void LoadPread(const std::vector<std::string>& vecFile, const std::vector<size_t>& vecIndex, const TCallback& fnCallback)
+    {
+        struct TDone
+        {
+            size_t nIndex;
+            int nRet;
+            std::vector<char> vecImage;
+        };
+        std::mutex oMutex;
+        std::condition_variable oCond;
+        std::deque<TDone*> queDone;
+        std::atomic<size_t> nNext(0);
+        size_t nThreadNum = MMin(MMax(m_nThreadNum, (size_t)1), vecIndex.size());
+        std::vector<std::thread> vecThread;
+        for (size_t t = 0; t < nThreadNum; t++)
+        {
+            vecThread.push_back(std::thread([&]()
+            {
+                for (size_t i = nNext++; i < vecIndex.size(); i = nNext++)
+                {
+                    TDone* pDone = new TDone;
+                    pDone->nIndex = vecIndex[i];
+                    pDone->nRet = ReadImage(vecFile[pDone->nIndex], m_nProbeSize, pDone->vecImage);
+                    std::lock_guard<std::mutex> oLock(oMutex);
+                    queDone.push_back(pDone);
+                    oCond.notify_one();
+                }
+            }));
+        }
+        for (size_t nDelivered = 0; nDelivered < vecIndex.size(); nDelivered++)
+        {
+            TDone* pDone = NULL;
+            {
+                std::unique_lock<std::mutex> oLock(oMutex);
+                oCond.wait(oLock, [&]() { return !queDone.empty(); });
+                pDone = queDone.front();
+                queDone.pop_front();
+            }
+            Deliver(pDone->nIndex, vecFile[pDone->nIndex], pDone->nRet, pDone->vecImage, fnCallback);
+            delete pDone;
+        }
+        for (size_t t = 0; t < vecThread.size(); t++)
+        {
+            vecThread[t].join();
+        }
+    }
+
+#ifdef PDBF_IO_URING
+    // ļļ״̬
+    struct TUringTask
+    {
+        enum EStage { OPEN, READ_HEAD, READ_REST, CLOSE };
+        size_t nSlot;
+        size_t nIndex;
+        int nStage;
+        int nFd;
+        int nRet;
+        size_t nDone;
+        std::vector<char> vecImage;
+    };
+
+    // io_uringأдʧʱDBF_ERRORں˲֧OPENATȲ;ύʧδļvecLeft
+    int LoadUring(const std::vector<std::string>& vecFile, const TCallback& fnCallback, std::vector<size_t>& vecLeft)
+    {
+        size_t nDepth = MMin(MMax(m_nQueueDepth, (size_t)1), (size_t)4096);
+        CDbfUring oRing;
+        if (oRing.Init((unsigned int)nDepth))
+        {
+            return CIDbf::DBF_ERROR;
+        }
+        std::vector<TUringTask> vecTask(MMin(nDepth, vecFile.size()));
+        std::vector<size_t> vecFree;
+        for (size_t i = 0; i < vecTask.size(); i++)
+        {
+            vecTask[i].nSlot = i;
+            vecTask[i].nFd = -1;
+            vecFree.push_back(i);
+        }
+        size_t nNext = 0;
+        size_t nActive = 0;
+        while (nNext < vecFile.size() || nActive > 0)
+        {
+            // вλʼļ
+            while (nNext < vecFile.size() && !vecFree.empty())
+            {
+                TUringTask& oTask = vecTask[vecFree.back()];
+                oTask.nIndex = nNext++;
+                oTask.nStage = TUringTask::OPEN;
+                oTask.nFd = -1;
+                oTask.nRet = CIDbf::DBF_SUCC;
+                oTask.nDone = 0;
+                io_uring_sqe* pSqe = oRing.GetSqe();
+                assert(pSqe);
+                pSqe->opcode = IORING_OP_OPENAT;
+                pSqe->fd = AT_FDCWD;
+                pSqe->addr = (unsigned long long)(uintptr_t)vecFile[oTask.nIndex].c_str();
+                pSqe->open_flags = O_RDONLY | O_CLOEXEC;
+                pSqe->user_data = vecFree.back();
+                vecFree.pop_back();
+                nActive++;
+            }
+            if (oRing.Submit(1))
+            {
+                // ύʧʱδɵļpreadȡ
+                // رնвȴеĲȵںд桢OPENAT򿪵ľͷvecTask
+                // ںδȡߵύִУеCLOSEر
+                io_uring_sqe oSqe;
+                while (oRing.Unqueue(oSqe))
+                {
+                    if (oSqe.opcode == IORING_OP_CLOSE)
+                    {
+                        close(oSqe.fd);
+                    }
+                }
+                unsigned long long nUserData = 0;
+                int nRes = 0;
+                while (oRing.Inflight() > 0)
+                {
+                    while (oRing.PopCqe(nUserData, nRes))
+                    {
+                        TUringTask& oTask = vecTask[(size_t)nUserData];
+                        if (oTask.nStage == TUringTask::OPEN && nRes >= 0)
+                        {
+                            oTask.nFd = nRes;
+                        }
+                    }
+                    if (oRing.Inflight() > 0 && oRing.Wait())
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                oRing.Close();
+                for (size_t i = 0; i < vecTask.size(); i++)
+                {
+                    if (std::find(vecFree.begin(), vecFree.end(), i) == vecFree.end())
+                    {
+                        if (vecTask[i].nFd >= 0)
+                        {
+                            close(vecTask[i].nFd);
+                        }
+                        vecLeft.push_back(vecTask[i].nIndex);
+                    }
+                }
+                for (; nNext < vecFile.size(); nNext++)
+                {
+                    vecLeft.push_back(nNext);
+                }
+                return CIDbf::DBF_SUCC;
+            }
+            unsigned long long nUserData = 0;
+            int nRes = 0;
+            while (oRing.PopCqe(nUserData, nRes))
+            {
+                TUringTask& oTask = vecTask[(size_t)nUserData];
+                if (!Advance(oRing, oTask, nRes))
+                {
+                    continue;
+                }
+                // ļ
+                if (oTask.nRet == CIDbf::DBF_PARA_ERROR)
+                {
+                    vecLeft.push_back(oTask.nIndex);
+                }
+                else
+                {
+                    Deliver(oTask.nIndex, vecFile[oTask.nIndex], oTask.nRet, oTask.vecImage, fnCallback);
+                }
+                std::vector<char>().swap(oTask.vecImage);
+                oTask.nFd = -1;
+                vecFree.push_back((size_t)nUserData);
+                nActive--;
+            }
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // һύһļʱtrue
+    // nRetΪDBF_PARA_ERRORʾں˲ָ֧òpreadȡ
+    bool Advance(CDbfUring& oRing, TUringTask& oTask, int nRes)
+    {
+        switch (oTask.nStage)
+        {
+        case TUringTask::OPEN:
+            if (nRes < 0)
+            {
+                oTask.nRet = nRes == -EINVAL || nRes == -EOPNOTSUPP || nRes == -ENOSYS ? CIDbf::DBF_PARA_ERROR : CIDbf::DBF_FILE_ERROR;
+                return true;
+            }
+            oTask.nFd = nRes;
+            oTask.nStage = TUringTask::READ_HEAD;
+            oTask.vecImage.resize(MMax(m_nProbeSize, sizeof(TDbfHeader)));
+            SubmitRead(oRing, oTask);
+            return false;
+        case TUringTask::READ_HEAD:
+        case TUringTask::READ_REST:
+            if (nRes < 0)
+            {
+                oTask.nRet = nRes == -EINVAL || nRes == -EOPNOTSUPP ? CIDbf::DBF_PARA_ERROR : CIDbf::DBF_FILE_ERROR;
+                SubmitClose(oRing, oTask);
+                return false;
+            }
+            oTask.nDone += nRes;
+            if (oTask.nStage == TUringTask::READ_HEAD && (nRes == 0 || oTask.nDone == oTask.vecImage.size()))
+            {
+                // ͷ꣬ļͷȷӳС
+                size_t nExpect = ImageSize(oTask.vecImage, oTask.nDone);
+                if (nExpect == 0)
+                {
+                    oTask.nRet = CIDbf::DBF_FILE_ERROR;
+                    SubmitClose(oRing, oTask);
+                    return false;
+                }
+                oTask.vecImage.resize(nExpect);
+                oTask.nStage = TUringTask::READ_REST;
+                nRes = oTask.nDone >= nExpect ? 0 : nRes;
+            }
+            if (nRes == 0 || oTask.nDone >= oTask.vecImage.size())
+            {
+                // ļļͷĶ̣OpenInMemoryУ
+                oTask.vecImage.resize(MMin(oTask.nDone, oTask.vecImage.size()));
+                SubmitClose(oRing, oTask);
+                return false;
+            }
+            SubmitRead(oRing, oTask);
+            return false;
+        default:
+            return true;
+        }
+    }
+    void SubmitRead(CDbfUring& oRing, TUringTask& oTask)
+    {
+        io_uring_sqe* pSqe = oRing.GetSqe();
+        assert(pSqe);
+        pSqe->opcode = IORING_OP_READ;
+        pSqe->fd = oTask.nFd;
+        pSqe->addr = (unsigned long long)(uintptr_t)&oTask.vecImage[oTask.nDone];
+        pSqe->len = (unsigned int)MMin(oTask.vecImage.size() - oTask.nDone, (size_t)0x7FFFF000);
+        pSqe->off = oTask.nDone;
+        pSqe->user_data = oTask.nSlot;
+    }
+    void SubmitClose(CDbfUring& oRing, TUringTask& oTask)
+    {
+        oTask.nStage = TUringTask::CLOSE;
+        io_uring_sqe* pSqe = oRing.GetSqe();
+        assert(pSqe);
+        pSqe->opcode = IORING_OP_CLOSE;
+        pSqe->fd = oTask.nFd;
+        // رպܱãټ¼
+        oTask.nFd = -1;
+        pSqe->user_data = oTask.nSlot;
+    }
+#endif
+
+private:
+    bool m_bUringUsed;
+    size_t m_nFailNum;
+};
+
+#endif
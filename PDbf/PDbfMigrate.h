@@ -0,0 +1,352 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_MIGRATE_H__
+#define __P_DBF_MIGRATE_H__
+#include <thread>
+#include "PDbf.h"
+
+// ֶǨƲ
+enum EDbfMigrateOp
+{
+    DBF_MIG_COPY,   // ԭڵֶκϲΪһο
+    DBF_MIG_BLANK,  // ոֶ
+    DBF_MIG_LEFT,   // 뿽ضϣ㲹ոֶַθĳ
+    DBF_MIG_TRIM,   // ȥǰո룬ֵֶθΪֶַ
+    DBF_MIG_RIGHT,  // ȥ˿ոҶ룬Сλֵֶθĳȣʱ'*'
+    DBF_MIG_NUMBER, // Ϊֵ³ȼСλ¸ʽʱ'*'
+};
+
+// ֶǨƲ¼¼еλ
+class TDbfMigrateOp
+{
+public:
+    int nType;
+    // ԭ¼еλü
+    size_t nSrc;
+    size_t nSrcLen;
+    // ¼¼еλü
+    size_t nDst;
+    size_t nDstLen;
+    // ֶСλDBF_MIG_NUMBERʹ
+    int nPrecision;
+};
+
+// ṹǨ(ӡɾֶμ޸ֶγ)
+// ¾ֶԤÿ¼ֽڼǨƼƻδ仯ֱֶڴ濽仯ֶβ롢ضϻת
+// ÿ˳һ¼ֶζִ߳мƻһдļ
+class CDbfMigrate
+{
+public:
+    CDbfMigrate()
+    {
+        m_nThreadNum = MMax(std::thread::hardware_concurrency(), 1U);
+        m_nBatchRecs = 16 * 1024;
+        m_nTruncNum = 0;
+    }
+public:
+    // ߳
+    size_t m_nThreadNum;
+    // ÿ߳ÿִļ¼
+    size_t m_nBatchRecs;
+
+    // strSrcǨΪֶΪvecFieldļstrDst(ѴʱǣstrSrcͬ)
+    // vecSource[k]ΪkֶζӦԭֶΪմʱΪֶΣvecSourceΪʱֶӦ
+    // ԭļûеֶΪֶΣûбõԭֶαɾ
+    // дstrDst.tmpɹΪstrDstʧʱɾʱļstrDstֲ
+    int Migrate(const std::string& strSrc, const std::string& strDst, const std::vector<TDbfField>& vecField,
+        const std::vector<std::string>& vecSource = std::vector<std::string>())
+    {
+        m_nTruncNum = 0;
+        std::string strTemp = strDst + ".tmp";
+        int nRet = MigrateTo(strSrc, strTemp, vecField, vecSource);
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+#ifdef _WIN32
+            // Windowsrenameļ
+            remove(strDst.c_str());
+#endif
+            if (rename(strTemp.c_str(), strDst.c_str()))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        if (nRet)
+        {
+            remove(strTemp.c_str());
+        }
+        return nRet;
+    }
+
+    // һǨݱض(ֵֶΪ'*')ֶΪ0ʱûݶʧ
+    inline size_t GetTruncNum() const { return m_nTruncNum; }
+
+    // ǨƼƻvecMap[k]ΪkֶζӦԭֶţСԭֶʱΪֶ
+    static void MakePlan(const std::vector<TDbfField>& vecSrc, const std::vector<TDbfField>& vecDst,
+        const std::vector<size_t>& vecMap, std::vector<TDbfMigrateOp>& vecPlan)
+    {
+        vecPlan.clear();
+        // ɾ־
+        TDbfMigrateOp oOp;
+        memset(&oOp, 0, sizeof(oOp));
+        oOp.nType = DBF_MIG_COPY;
+        oOp.nSrcLen = 1;
+        oOp.nDstLen = 1;
+        vecPlan.push_back(oOp);
+        for (size_t i = 0; i < vecDst.size(); i++)
+        {
+            const TDbfField& oDst = vecDst[i];
+            oOp.nDst = oDst.nPosition;
+            oOp.nDstLen = oDst.cLength;
+            oOp.nPrecision = oDst.cPrecisionLength;
+            if (vecMap[i] >= vecSrc.size())
+            {
+                oOp.nType = DBF_MIG_BLANK;
+                oOp.nSrc = 0;
+                oOp.nSrcLen = 0;
+            }
+            else
+            {
+                const TDbfField& oSrc = vecSrc[vecMap[i]];
+                oOp.nSrc = oSrc.nPosition;
+                oOp.nSrcLen = oSrc.cLength;
+                if (oSrc.cType == oDst.cType && oSrc.cLength == oDst.cLength && oSrc.cPrecisionLength == oDst.cPrecisionLength)
+                {
+                    oOp.nType = DBF_MIG_COPY;
+                }
+                else if (IsNumber(oDst.cType))
+                {
+                    oOp.nType = IsNumber(oSrc.cType) && oSrc.cPrecisionLength == oDst.cPrecisionLength ? DBF_MIG_RIGHT : DBF_MIG_NUMBER;
+                }
+                else
+                {
+                    oOp.nType = IsNumber(oSrc.cType) ? DBF_MIG_TRIM : DBF_MIG_LEFT;
+                }
+            }
+            // һβʱϲ
+            TDbfMigrateOp& oLast = vecPlan.back();
+            if (oOp.nType == oLast.nType && oLast.nDst + oLast.nDstLen == oOp.nDst
+                && (oOp.nType == DBF_MIG_BLANK || (oOp.nType == DBF_MIG_COPY && oLast.nSrc + oLast.nSrcLen == oOp.nSrc)))
+            {
+                oLast.nSrcLen += oOp.nSrcLen;
+                oLast.nDstLen += oOp.nDstLen;
+                continue;
+            }
+            vecPlan.push_back(oOp);
+        }
+    }
+
+    // nNum¼ִǨƼƻݱضϵֶ
+    static size_t Apply(const std::vector<TDbfMigrateOp>& vecPlan, const char* pSrc, size_t nSrcLen,
+        char* pDst, size_t nDstLen, size_t nNum)
+    {
+        size_t nTrunc = 0;
+        char szBuf[512];
+        for (size_t i = 0; i < nNum; i++, pSrc += nSrcLen, pDst += nDstLen)
+        {
+            for (size_t k = 0; k < vecPlan.size(); k++)
+            {
+                const TDbfMigrateOp& oOp = vecPlan[k];
+                const char* pFrom = pSrc + oOp.nSrc;
+                const char* pEnd = pFrom + oOp.nSrcLen;
+                char* pTo = pDst + oOp.nDst;
+                switch (oOp.nType)
+                {
+                case DBF_MIG_COPY:
+                    memcpy(pTo, pFrom, oOp.nDstLen);
+                    break;
+                case DBF_MIG_BLANK:
+                    memset(pTo, ' ', oOp.nDstLen);
+                    break;
+                case DBF_MIG_LEFT:
+                case DBF_MIG_TRIM:
+                    if (oOp.nType == DBF_MIG_TRIM)
+                    {
+                        pFrom = SkipBlank(pFrom, pEnd);
+                    }
+                    nTrunc += Put(pTo, oOp.nDstLen, pFrom, TrimRight(pFrom, pEnd) - pFrom, false);
+                    break;
+                case DBF_MIG_RIGHT:
+                    pFrom = SkipBlank(pFrom, pEnd);
+                    nTrunc += Put(pTo, oOp.nDstLen, pFrom, TrimRight(pFrom, pEnd) - pFrom, true);
+                    break;
+                case DBF_MIG_NUMBER:
+                    // ֵΪ
+                    if (SkipBlank(pFrom, pEnd) == pEnd)
+                    {
+                        memset(pTo, ' ', oOp.nDstLen);
+                        break;
+                    }
+                    nTrunc += Put(pTo, oOp.nDstLen, szBuf, CDbfFastParse::FormatDouble(szBuf, sizeof(szBuf),
+                        CDbfFastParse::ToDouble(pFrom, oOp.nSrcLen), (int)oOp.nDstLen, oOp.nPrecision), true);
+                    break;
+                }
+            }
+        }
+        return nTrunc;
+    }
+
+private:
+    static bool IsNumber(char cType)
+    {
+        return cType == 'N' || cType == 'F';
+    }
+    static const char* SkipBlank(const char* p, const char* pEnd)
+    {
+        while (p < pEnd && *p == ' ')
+        {
+            p++;
+        }
+        return p;
+    }
+    static const char* TrimRight(const char* p, const char* pEnd)
+    {
+        while (pEnd > p && pEnd[-1] == ' ')
+        {
+            pEnd--;
+        }
+        return pEnd;
+    }
+    // дnLenֽݣֶַ롢ֵֶҶ벹ո񣬳ʱ1
+    // ֶַαֵֶ࣬αֻɴֵdBaseֶ'*'
+    static size_t Put(char* pTo, size_t nDstLen, const char* pFrom, size_t nLen, bool bNumber)
+    {
+        if (nLen > nDstLen)
+        {
+            if (bNumber)
+            {
+                memset(pTo, '*', nDstLen);
+            }
+            else
+            {
+                memcpy(pTo, pFrom, nDstLen);
+            }
+            return 1;
+        }
+        size_t nPad = nDstLen - nLen;
+        memset(bNumber ? pTo : pTo + nLen, ' ', nPad);
+        memcpy(bNumber ? pTo + nPad : pTo, pFrom, nLen);
+        return 0;
+    }
+
+private:
+    // ǨƵstrDstغļѹر
+    int MigrateTo(const std::string& strSrc, const std::string& strDst, const std::vector<TDbfField>& vecField,
+        const std::vector<std::string>& vecSource = std::vector<std::string>())
+    {
+        CPDbf oSrc;
+        if (oSrc.Open(strSrc))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        std::vector<TDbfField> vecSrcField = oSrc.GetField();
+        std::vector<size_t> vecMap(vecField.size());
+        if (!vecSource.empty() && vecSource.size() != vecField.size())
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        for (size_t i = 0; i < vecField.size(); i++)
+        {
+            if (vecSource.empty())
+            {
+                vecMap[i] = CPDbf::FindField(vecSrcField, std::string(vecField[i].szName, strnlen(vecField[i].szName, sizeof(vecField[i].szName))));
+                continue;
+            }
+            vecMap[i] = vecSource[i].empty() ? vecSrcField.size() : CPDbf::FindField(vecSrcField, vecSource[i]);
+            if (!vecSource[i].empty() && vecMap[i] >= vecSrcField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+        }
+
+        // ļֶλԴΪ׼
+        CPDbf oDst;
+        int nRet = oDst.Create(strDst, vecField);
+        if (nRet)
+        {
+            return nRet;
+        }
+        std::vector<TDbfMigrateOp> vecPlan;
+        MakePlan(vecSrcField, oDst.GetField(), vecMap, vecPlan);
+
+        // ÿֶm_nThreadNum*m_nBatchRecs¼ֶβǨƺ˳д
+        size_t nThreadNum = MMax(m_nThreadNum, (size_t)1);
+        size_t nBatchRecs = MMax(m_nBatchRecs, (size_t)1);
+        size_t nSrcLen = oSrc.GetRecLen();
+        size_t nDstLen = oDst.GetRecLen();
+        size_t nRecNum = oSrc.GetRecNum();
+        std::vector<char> vecOut;
+        std::vector<size_t> vecTrunc(nThreadNum);
+        for (size_t nRecNo = 0; nRecNo < nRecNum; nRecNo += nThreadNum * nBatchRecs)
+        {
+            size_t nNum = MMin(nThreadNum * nBatchRecs, nRecNum - nRecNo);
+            if (oSrc.Read(nRecNo, nNum))
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            vecOut.resize(nNum * nDstLen);
+            size_t nPart = (nNum + nBatchRecs - 1) / nBatchRecs;
+            std::vector<std::thread> vecThread;
+            for (size_t i = 0; i < nPart; i++)
+            {
+                size_t nPartNum = MMin(nBatchRecs, nNum - i * nBatchRecs);
+                const char* pSrc = oSrc.ReadData(i * nBatchRecs);
+                char* pDst = &vecOut[i * nBatchRecs * nDstLen];
+                if (nPart == 1)
+                {
+                    vecTrunc[i] += Apply(vecPlan, pSrc, nSrcLen, pDst, nDstLen, nPartNum);
+                }
+                else
+                {
+                    vecThread.push_back(std::thread([&vecPlan, &vecTrunc, i, pSrc, nSrcLen, pDst, nDstLen, nPartNum]()
+                    {
+                        vecTrunc[i] += Apply(vecPlan, pSrc, nSrcLen, pDst, nDstLen, nPartNum);
+                    }));
+                }
+            }
+            for (size_t i = 0; i < vecThread.size(); i++)
+            {
+                vecThread[i].join();
+            }
+            nRet = oDst.WriteRecord(nRecNo, &vecOut[0], nNum);
+            if (nRet)
+            {
+                return nRet;
+            }
+        }
+        for (size_t i = 0; i < nThreadNum; i++)
+        {
+            m_nTruncNum += vecTrunc[i];
+        }
+        if (oDst.FileCommit() || oDst.Flush())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // һǨбضϵֶ
+    size_t m_nTruncNum;
+};
+
+#endif
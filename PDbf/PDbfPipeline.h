@@ -0,0 +1,285 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_PIPELINE_H__
+#define __P_DBF_PIPELINE_H__
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <thread>
+#include "PDbf.h"
+#include "../HighlyConcurrent/readerwriterqueue/readerwriterqueue.h"
+
+// ˮеһ¼
+class TDbfPipeBatch
+{
+public:
+    TDbfPipeBatch(size_t nRecCapacity, size_t nRecLen)
+        : oRaw(nRecCapacity, nRecLen)
+    {
+        nSeq = 0;
+        nRecNo = 0;
+        nNum = 0;
+        nRet = CIDbf::DBF_SUCC;
+    }
+public:
+    // ţ0ʼ
+    size_t nSeq;
+    // һ¼ļ¼
+    size_t nRecNo;
+    // ¼
+    size_t nNum;
+    // ȡ
+    int nRet;
+    // ԭʼ¼
+    CRecordBuf oRaw;
+    // ֵvecValue[k][i]Ϊkֶεi¼δֶΪ
+    std::vector<std::vector<double> > vecValue;
+
+    // i¼ԭʼ
+    inline const char* Record(size_t i) { return oRaw.Data() + i * oRaw.RecLen(); }
+    // kֶεi¼ֵ
+    inline double Value(size_t k, size_t i) const { return vecValue[k][i]; }
+    // ֶǷѽ
+    inline bool IsDecoded(size_t k) const { return k < vecValue.size() && !vecValue[k].empty(); }
+
+private:
+    TDbfPipeBatch(const TDbfPipeBatch&);
+    TDbfPipeBatch& operator=(const TDbfPipeBatch&);
+};
+
+// ȡ--ˮ
+// һ̰߳ȡ¼ָm_nThreadNuṃ߳ÿ߳Լĵߵ߶У
+// ֵֶ̰߳νΪdoublḛ߳δӶӦ̵߳ȡص
+// 䣬ȡģɻָԭʼ˳򣻴ξնл߳ظʹã
+// вڴ
+class CDbfPipeline
+{
+public:
+    typedef moodycamel::BlockingReaderWriterQueue<TDbfPipeBatch*> TQueue;
+    // ¼˳صÿһط0ʱֹͣ
+    typedef std::function<int(TDbfPipeBatch& oBatch)> TCallback;
+    // ߳жÿִеĴֵ֮
+    typedef std::function<void(TDbfPipeBatch& oBatch)> TDecode;
+
+    CDbfPipeline()
+    {
+        m_nThreadNum = MMax(std::thread::hardware_concurrency(), 1U);
+        m_nBatchRecs = 10000;
+        m_nDepth = 2;
+    }
+public:
+    // ߳
+    size_t m_nThreadNum;
+    // ÿ¼
+    size_t m_nBatchRecs;
+    // ÿ߳̿ͬʱеܻΪm_nThreadNum*m_nDepth+1
+    size_t m_nDepth;
+    // ߳еԶ崦Ϊ
+    TDecode m_fnDecode;
+
+    // ҪΪֵֶΣΪʱNFֶ
+    void SetColumns(const std::vector<std::string>& vecName)
+    {
+        m_vecName = vecName;
+    }
+
+    // oDbf[nRecNo, nRecNo+nRecNum)ļ¼nRecNumΪ0ʱļĩβ
+    // ڼoDbfֻɶ̷߳ʣصڵ߳а¼˳ִ
+    int Run(CPDbf& oDbf, const TCallback& fnCallback, size_t nRecNo = 0, size_t nRecNum = 0)
+    {
+        if (!oDbf.IsOpen())
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nTotal = oDbf.GetRecNum();
+        if (nRecNo > nTotal)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        size_t nEnd = nRecNum ? nRecNo + nRecNum : nTotal;
+        if (nEnd < nRecNo || nEnd > nTotal)
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        // ֶ
+        std::vector<TDbfField> vecField = oDbf.GetField();
+        std::vector<bool> vecDecode(vecField.size(), false);
+        for (size_t i = 0; i < vecField.size(); i++)
+        {
+            vecDecode[i] = m_vecName.empty() && (vecField[i].cType == 'N' || vecField[i].cType == 'F');
+        }
+        for (size_t i = 0; i < m_vecName.size(); i++)
+        {
+            size_t k = CPDbf::FindField(vecField, m_vecName[i]);
+            if (k >= vecField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            vecDecode[k] = true;
+        }
+
+        // Ԥ
+        size_t nThreadNum = MMax(m_nThreadNum, (size_t)1);
+        size_t nBatchRecs = MMax(m_nBatchRecs, (size_t)1);
+        size_t nBatchNum = nThreadNum * MMax(m_nDepth, (size_t)1) + 1;
+        std::vector<TDbfPipeBatch*> vecBatch(nBatchNum);
+        TQueue oFree(nBatchNum);
+        for (size_t i = 0; i < nBatchNum; i++)
+        {
+            vecBatch[i] = new TDbfPipeBatch(nBatchRecs, oDbf.GetRecLen());
+            vecBatch[i]->vecValue.resize(vecField.size());
+            for (size_t k = 0; k < vecField.size(); k++)
+            {
+                if (vecDecode[k])
+                {
+                    vecBatch[i]->vecValue[k].resize(nBatchRecs);
+                }
+            }
+            oFree.enqueue(vecBatch[i]);
+        }
+        // ÿ̵߳뼰У㹻κͽ־ʱڴ
+        std::deque<TQueue> vecIn, vecOut;
+        for (size_t t = 0; t < nThreadNum; t++)
+        {
+            vecIn.emplace_back(nBatchNum + 1);
+            vecOut.emplace_back(nBatchNum + 1);
+        }
+
+        // ̺߳ͽ߳
+        std::atomic<bool> bStop(false);
+        std::vector<std::thread> vecThread;
+        vecThread.push_back(std::thread(&CDbfPipeline::ReadLoop, &oDbf, nRecNo, nEnd, nBatchRecs,
+            &oFree, std::ref(vecIn), std::ref(bStop)));
+        for (size_t t = 0; t < nThreadNum; t++)
+        {
+            vecThread.push_back(std::thread(&CDbfPipeline::DecodeLoop, this, &vecField, &vecIn[t], &vecOut[t]));
+        }
+
+        // ȡֹͣȡֱ־ʹ̺߳ͽܹ߳˳
+        int nRet = CIDbf::DBF_SUCC;
+        for (size_t nSeq = 0; ; nSeq++)
+        {
+            TDbfPipeBatch* pBatch = NULL;
+            vecOut[nSeq % nThreadNum].wait_dequeue(pBatch);
+            if (!pBatch)
+            {
+                break;
+            }
+            if (!bStop)
+            {
+                if (pBatch->nRet)
+                {
+                    nRet = pBatch->nRet;
+                    bStop = true;
+                }
+                else if (fnCallback(*pBatch))
+                {
+                    bStop = true;
+                }
+            }
+            oFree.enqueue(pBatch);
+        }
+
+        for (size_t i = 0; i < vecThread.size(); i++)
+        {
+            vecThread[i].join();
+        }
+        for (size_t i = 0; i < nBatchNum; i++)
+        {
+            delete vecBatch[i];
+        }
+        return nRet;
+    }
+
+private:
+    // ̣߳ӻնȡζ¼ָ̣߳н̷߳ͽ־
+    static void ReadLoop(CPDbf* pDbf, size_t nRecNo, size_t nEnd, size_t nBatchRecs,
+        TQueue* pFree, std::deque<TQueue>& vecIn, std::atomic<bool>& bStop)
+    {
+        size_t nSeq = 0;
+        for (size_t i = nRecNo; i < nEnd && !bStop; i += nBatchRecs, nSeq++)
+        {
+            TDbfPipeBatch* pBatch = NULL;
+            pFree->wait_dequeue(pBatch);
+            pBatch->nSeq = nSeq;
+            pBatch->nRecNo = i;
+            pBatch->nNum = MMin(nBatchRecs, nEnd - i);
+            pBatch->nRet = pDbf->ReadRecord(i, pBatch->oRaw.Data(), pBatch->nNum);
+            pBatch->oRaw.RecNum() = pBatch->nRet ? 0 : pBatch->nNum;
+            vecIn[nSeq % vecIn.size()].enqueue(pBatch);
+            if (pBatch->nRet)
+            {
+                nSeq++;
+                break;
+            }
+        }
+        // ־һŶӦĶпʼ̰ͣ߳ȡĵһΪ
+        for (size_t t = 0; t < vecIn.size(); t++)
+        {
+            vecIn[(nSeq + t) % vecIn.size()].enqueue((TDbfPipeBatch*)NULL);
+        }
+    }
+
+    // ֵֶ̣߳κ󽻸߳
+    void DecodeLoop(const std::vector<TDbfField>* pField, TQueue* pIn, TQueue* pOut)
+    {
+        while (true)
+        {
+            TDbfPipeBatch* pBatch = NULL;
+            pIn->wait_dequeue(pBatch);
+            if (pBatch && !pBatch->nRet)
+            {
+                for (size_t k = 0; k < pBatch->vecValue.size(); k++)
+                {
+                    std::vector<double>& vecValue = pBatch->vecValue[k];
+                    if (vecValue.empty())
+                    {
+                        continue;
+                    }
+                    const TDbfField& oField = (*pField)[k];
+                    const char* pRec = pBatch->oRaw.Data() + oField.nPosition;
+                    for (size_t i = 0; i < pBatch->nNum; i++, pRec += pBatch->oRaw.RecLen())
+                    {
+                        vecValue[i] = CDbfFastParse::ToDouble(pRec, oField.cLength);
+                    }
+                }
+                if (m_fnDecode)
+                {
+                    m_fnDecode(*pBatch);
+                }
+            }
+            pOut->enqueue(pBatch);
+            if (!pBatch)
+            {
+                break;
+            }
+        }
+    }
+
+private:
+    // Ҫֶ
+    std::vector<std::string> m_vecName;
+};
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_RCU_H__
+#define __P_DBF_RCU_H__
+#include <atomic>
+#include <mutex>
+#include "PDbf.h"
+
+// DBFڴգغֻ
+// ̹߳ͬһʱʹRecord/ReadField(nRecNo, nCol)״̬ӿڣ
+// Read/ReadGoָӿֻһ߳ʹ
+class CDbfSnapshot : public CDbfTableView
+{
+public:
+    int Load(CPDbf& oDbf)
+    {
+        int nRet = oDbf.ReadImage(m_vecImage);
+        if (nRet)
+        {
+            return nRet;
+        }
+        return Attach(&m_vecImage[0], m_vecImage.size());
+    }
+    int Load(const std::string& strFile)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return Load(oDbf);
+    }
+
+private:
+    // ļӳ
+    std::vector<char> m_vecImage;
+};
+
+// ֧ȼصڴ
+// ǰͨԭָ뷢̲߳ȴ¼ʱں̨ļ
+// ɺԭ滻ɿհepochӳٻգһĶ߳뿪ͷ
+//
+//  CDbfRcuTable oTable;
+//  oTable.Load(strFile);
+//  // ߳
+//  CDbfRcuTable::CReader oReader(oTable);
+//  {
+//      CDbfRcuTable::CGuard oGuard(oReader);
+//      oGuard->ReadField(nRecNo, nCol, strValue);
+//  }
+class CDbfRcuTable
+{
+public:
+    // ߳
+    enum { MAX_READERS = 256 };
+
+    CDbfRcuTable()
+        : m_pCur(NULL), m_nEpoch(1), m_nRetired(0)
+    {
+        for (size_t i = 0; i < MAX_READERS; i++)
+        {
+            m_arrSlot[i].nEpoch.store(0);
+            m_arrSlot[i].bUsed.store(false);
+        }
+    }
+    // ʱж߳
+    ~CDbfRcuTable()
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        delete m_pCur.load();
+        for (size_t i = 0; i < m_vecRetired.size(); i++)
+        {
+            delete m_vecRetired[i].first;
+        }
+        m_vecRetired.clear();
+    }
+
+    // ļΪǰգڼ̼߳ʹþɿ
+    int Load(const std::string& strFile)
+    {
+        CDbfSnapshot* pSnapshot = new CDbfSnapshot();
+        int nRet = pSnapshot->Load(strFile);
+        if (nRet)
+        {
+            delete pSnapshot;
+            return nRet;
+        }
+        Publish(pSnapshot);
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ¿գӹpSnapshotȨ
+    void Publish(CDbfSnapshot* pSnapshot)
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        CDbfSnapshot* pOld = m_pCur.exchange(pSnapshot);
+        // ɿֻܱepochnRetireĶ߳
+        unsigned long long nRetire = m_nEpoch.fetch_add(1);
+        if (pOld)
+        {
+            m_vecRetired.push_back(std::make_pair(pOld, nRetire));
+            m_nRetired.fetch_add(1);
+        }
+        Reclaim();
+    }
+
+    // ȴյĿ
+    inline size_t GetRetiredNum() const { return m_nRetired.load(); }
+
+    // ߳̾ÿ߳һʱռһλ
+    class CReader
+    {
+    public:
+        CReader(CDbfRcuTable& oTable)
+            : m_oTable(oTable)
+        {
+            m_nSlot = oTable.AcquireSlot();
+        }
+        ~CReader()
+        {
+            if (m_nSlot < MAX_READERS)
+            {
+                m_oTable.m_arrSlot[m_nSlot].nEpoch.store(0);
+                m_oTable.m_arrSlot[m_nSlot].bUsed.store(false);
+            }
+        }
+        // λʱfalseʱEnterNULL
+        inline bool IsValid() const { return m_nSlot < MAX_READERS; }
+
+        // ٽصǰգδʱNULL
+        const CDbfSnapshot* Enter()
+        {
+            if (!IsValid())
+            {
+                return NULL;
+            }
+            // ȹepochٶȡָ룬֤߳ܿ߳
+            m_oTable.m_arrSlot[m_nSlot].nEpoch.store(m_oTable.m_nEpoch.load());
+            return m_oTable.m_pCur.load();
+        }
+        // 뿪ٽ֮ʹEnterصĿ
+        void Leave()
+        {
+            if (!IsValid())
+            {
+                return;
+            }
+            m_oTable.m_arrSlot[m_nSlot].nEpoch.store(0, std::memory_order_release);
+            // дյĿʱԻգȴд߳
+            if (m_oTable.m_nRetired.load(std::memory_order_relaxed))
+            {
+                std::unique_lock<std::mutex> oLock(m_oTable.m_oMutex, std::try_to_lock);
+                if (oLock.owns_lock())
+                {
+                    m_oTable.Reclaim();
+                }
+            }
+        }
+
+    private:
+        CReader(const CReader&);
+        CReader& operator=(const CReader&);
+
+        CDbfRcuTable& m_oTable;
+        size_t m_nSlot;
+    };
+
+    // ٽ
+    class CGuard
+    {
+    public:
+        CGuard(CReader& oReader)
+            : m_oReader(oReader)
+        {
+            m_pSnapshot = oReader.Enter();
+        }
+        ~CGuard()
+        {
+            m_oReader.Leave();
+        }
+        inline const CDbfSnapshot* Get() const { return m_pSnapshot; }
+        inline const CDbfSnapshot* operator->() const { return m_pSnapshot; }
+
+    private:
+        CGuard(const CGuard&);
+        CGuard& operator=(const CGuard&);
+
+        CReader& m_oReader;
+        const CDbfSnapshot* m_pSnapshot;
+    };
+
+private:
+    // ռÿжλʧܷMAX_READERS
+    size_t AcquireSlot()
+    {
+        for (size_t i = 0; i < MAX_READERS; i++)
+        {
+            bool bUsed = false;
+            if (m_arrSlot[i].bUsed.compare_exchange_strong(bUsed, true))
+            {
+                return i;
+            }
+        }
+        return MAX_READERS;
+    }
+
+    // ͷûж߳õľɿգǰm_oMutex
+    void Reclaim()
+    {
+        if (m_vecRetired.empty())
+        {
+            return;
+        }
+        // ߳Сepoch
+        unsigned long long nMin = ~0ULL;
+        for (size_t i = 0; i < MAX_READERS; i++)
+        {
+            unsigned long long nEpoch = m_arrSlot[i].nEpoch.load();
+            if (nEpoch && nEpoch < nMin)
+            {
+                nMin = nEpoch;
+            }
+        }
+        size_t nKeep = 0;
+        for (size_t i = 0; i < m_vecRetired.size(); i++)
+        {
+            if (m_vecRetired[i].second < nMin)
+            {
+                delete m_vecRetired[i].first;
+            }
+            else
+            {
+                m_vecRetired[nKeep++] = m_vecRetired[i];
+            }
+        }
+        m_vecRetired.resize(nKeep);
+        m_nRetired.store(nKeep);
+    }
+
+private:
+    // λжα
+    struct alignas(64) TSlot
+    {
+        std::atomic<unsigned long long> nEpoch;     // ʱepoch0ʾڶٽ
+        std::atomic<bool> bUsed;                    // Ƿѱ߳ռ
+    };
+
+    // ǰ
+    std::atomic<CDbfSnapshot*> m_pCur;
+    // ȫepoch
+    std::atomic<unsigned long long> m_nEpoch;
+    // ȴյĿ
+    std::atomic<size_t> m_nRetired;
+    // λ
+    TSlot m_arrSlot[MAX_READERS];
+    // д̻߳⼰տ
+    std::mutex m_oMutex;
+    std::vector<std::pair<CDbfSnapshot*, unsigned long long> > m_vecRetired;
+};
+
+#endif
@@ -0,0 +1,365 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_SHM_H__
+#define __P_DBF_SHM_H__
+#include <atomic>
+#include "PDbf.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+// ڴƶΣ¼ǰİ汾
+class TDbfShmControl
+{
+public:
+    char                                szMagic[4];     // ־"PDBC"
+    unsigned int                        nReserved;      // 
+    std::atomic<unsigned long long>     nVersion;       // ǰ汾0ʾδ
+};
+// ڴݶͷΪDBFļӳ
+class TDbfShmHeader
+{
+public:
+    char                szMagic[4];     // ־"PDBS"
+    unsigned int        nFormat;        // ʽ汾
+    unsigned long long  nVersion;       // ݰ汾
+    unsigned long long  nImageSize;     // ļӳ񳤶
+    char                szReserved[40]; // 
+};
+
+// ڴ
+// ƶΪstrNameÿ汾ݶΪstrName.汾ţ°汾ʱдݶΣ
+// ԭӸ¿ƶεİ汾ţɾݶƣӳݶεĶ̲Ӱ
+// ֧POSIXڴ棬Windows½ӿڷDBF_ERROR
+class CDbfShm
+{
+public:
+    // ڴ'/'ͷ
+    static std::string Name(const std::string& strName)
+    {
+        return (!strName.empty() && strName[0] == '/') ? strName : "/" + strName;
+    }
+    static std::string DataName(const std::string& strName, unsigned long long nVersion)
+    {
+        char szBuf[32] = { 0 };
+        sprintf_s(szBuf, ".%llu", nVersion);
+        return Name(strName) + szBuf;
+    }
+    // ӳ乲ڴ棬nSizeΪ0ʱдСӳ䣬NULLʾʧ
+    static void* Map(const std::string& strName, bool bCreate, bool bWrite, size_t& nSize)
+    {
+#ifndef _WIN32
+        int nFlag = bWrite ? O_RDWR : O_RDONLY;
+        if (bCreate)
+        {
+            nFlag |= O_CREAT;
+        }
+        int nFd = shm_open(strName.c_str(), nFlag, 0644);
+        if (nFd < 0)
+        {
+            return NULL;
+        }
+        struct stat oStat;
+        if (fstat(nFd, &oStat))
+        {
+            close(nFd);
+            return NULL;
+        }
+        if (nSize == 0)
+        {
+            nSize = oStat.st_size;
+        }
+        else if ((size_t)oStat.st_size != nSize && (!bWrite || ftruncate(nFd, nSize)))
+        {
+            close(nFd);
+            return NULL;
+        }
+        void* pAddr = nSize ? mmap(NULL, nSize, bWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, nFd, 0) : MAP_FAILED;
+        close(nFd);
+        return pAddr == MAP_FAILED ? NULL : pAddr;
+#else
+        return NULL;
+#endif
+    }
+    static void Unmap(void* pAddr, size_t nSize)
+    {
+#ifndef _WIN32
+        if (pAddr)
+        {
+            munmap(pAddr, nSize);
+        }
+#endif
+    }
+    static void Unlink(const std::string& strName)
+    {
+#ifndef _WIN32
+        shm_unlink(strName.c_str());
+#endif
+    }
+};
+
+// DBFڴ淢һֻһд
+class CDbfShmPublisher
+{
+public:
+    CDbfShmPublisher()
+    {
+        m_pControl = NULL;
+        m_nVersion = 0;
+    }
+    ~CDbfShmPublisher()
+    {
+        Close();
+    }
+
+    // Ѵ򿪵ļΪ°汾
+    int Publish(const std::string& strName, CPDbf& oDbf)
+    {
+        std::vector<char> vecImage;
+        int nRet = oDbf.ReadImage(vecImage);
+        if (nRet)
+        {
+            return nRet;
+        }
+        return Publish(strName, &vecImage[0], vecImage.size());
+    }
+    int Publish(const std::string& strName, const std::string& strFile)
+    {
+        CPDbf oDbf;
+        if (oDbf.Open(strFile, true))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return Publish(strName, oDbf);
+    }
+    // ļӳ
+    int Publish(const std::string& strName, const char* pImage, size_t nSize)
+    {
+        // Уӳ
+        CDbfTableView oView;
+        if (oView.Attach(pImage, nSize))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (!m_pControl || strName != m_strName)
+        {
+            Close();
+            size_t nCtrlSize = sizeof(TDbfShmControl);
+            m_pControl = (TDbfShmControl*)CDbfShm::Map(CDbfShm::Name(strName), true, true, nCtrlSize);
+            if (!m_pControl)
+            {
+                return CIDbf::DBF_ERROR;
+            }
+            memcpy(m_pControl->szMagic, "PDBC", sizeof(m_pControl->szMagic));
+            m_strName = strName;
+            // ʱѷİ汾
+            m_nVersion = m_pControl->nVersion.load(std::memory_order_acquire);
+        }
+
+        // д°汾ݶ
+        unsigned long long nOld = m_nVersion;
+        unsigned long long nNew = nOld + 1;
+        std::string strData = CDbfShm::DataName(strName, nNew);
+        CDbfShm::Unlink(strData);
+        size_t nDataSize = sizeof(TDbfShmHeader) + nSize;
+        char* pData = (char*)CDbfShm::Map(strData, true, true, nDataSize);
+        if (!pData)
+        {
+            return CIDbf::DBF_ERROR;
+        }
+        TDbfShmHeader oHeader;
+        memset(&oHeader, 0, sizeof(oHeader));
+        memcpy(oHeader.szMagic, "PDBS", sizeof(oHeader.szMagic));
+        oHeader.nFormat = 1;
+        oHeader.nVersion = nNew;
+        oHeader.nImageSize = nSize;
+        memcpy(pData, &oHeader, sizeof(oHeader));
+        memcpy(pData + sizeof(oHeader), pImage, nSize);
+        CDbfShm::Unmap(pData, nDataSize);
+
+        // л汾ɾɰ汾
+        m_pControl->nVersion.store(nNew, std::memory_order_release);
+        m_nVersion = nNew;
+        if (nOld)
+        {
+            CDbfShm::Unlink(CDbfShm::DataName(strName, nOld));
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ɾڴƣѴ򿪵Ķ̲Ӱ
+    void Unlink()
+    {
+        if (m_strName.empty())
+        {
+            return;
+        }
+        if (m_nVersion)
+        {
+            CDbfShm::Unlink(CDbfShm::DataName(m_strName, m_nVersion));
+        }
+        CDbfShm::Unlink(CDbfShm::Name(m_strName));
+        Close();
+    }
+
+    // رտƶΣɾѷ
+    void Close()
+    {
+        CDbfShm::Unmap(m_pControl, sizeof(TDbfShmControl));
+        m_pControl = NULL;
+        m_strName.clear();
+        m_nVersion = 0;
+    }
+
+    inline unsigned long long GetVersion() const { return m_nVersion; }
+
+private:
+    // 
+    std::string m_strName;
+    // ƶ
+    TDbfShmControl* m_pControl;
+    // ǰ汾
+    unsigned long long m_nVersion;
+};
+
+// DBFڴȡṩCPDbfһµRead/ReadGo/ReadStringȽӿڣƼ¼
+// Reloadл°汾֮ǰͨRecord/ReadDataȡָʧЧ
+class CDbfShmReader : public CDbfTableView
+{
+public:
+    CDbfShmReader()
+    {
+        m_pControl = NULL;
+        m_pData = NULL;
+        m_nDataSize = 0;
+        m_nVersion = 0;
+    }
+    ~CDbfShmReader()
+    {
+        Close();
+    }
+
+    // ѷı
+    int Open(const std::string& strName)
+    {
+        Close();
+        size_t nCtrlSize = 0;
+        m_pControl = (TDbfShmControl*)CDbfShm::Map(CDbfShm::Name(strName), false, false, nCtrlSize);
+        if (!m_pControl || nCtrlSize < sizeof(TDbfShmControl) || memcmp(m_pControl->szMagic, "PDBC", sizeof(m_pControl->szMagic)))
+        {
+            CDbfShm::Unmap(m_pControl, nCtrlSize);
+            m_pControl = NULL;
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        m_strName = strName;
+        return Load();
+    }
+
+    // Ƿѷ°汾
+    bool IsStale() const
+    {
+        return m_pControl && m_pControl->nVersion.load(std::memory_order_acquire) != m_nVersion;
+    }
+
+    // °汾ʱл
+    int Reload()
+    {
+        if (!m_pControl)
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return IsStale() ? Load() : CIDbf::DBF_SUCC;
+    }
+
+    void Close()
+    {
+        Detach();
+        CDbfShm::Unmap(m_pData, m_nDataSize);
+        CDbfShm::Unmap(m_pControl, sizeof(TDbfShmControl));
+        m_pData = NULL;
+        m_nDataSize = 0;
+        m_pControl = NULL;
+        m_nVersion = 0;
+        m_strName.clear();
+    }
+
+    inline unsigned long long GetVersion() const { return m_nVersion; }
+
+private:
+    // ӳ䵱ǰ汾ȡ汾źݶοѱ滻ʱ¶ȡ汾
+    int Load()
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            unsigned long long nVersion = m_pControl->nVersion.load(std::memory_order_acquire);
+            if (!nVersion)
+            {
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            size_t nSize = 0;
+            char* pData = (char*)CDbfShm::Map(CDbfShm::DataName(m_strName, nVersion), false, false, nSize);
+            if (!pData)
+            {
+                continue;
+            }
+            const TDbfShmHeader* pHeader = (const TDbfShmHeader*)pData;
+            if (nSize < sizeof(TDbfShmHeader) || memcmp(pHeader->szMagic, "PDBS", sizeof(pHeader->szMagic))
+                || pHeader->nVersion != nVersion || pHeader->nImageSize > nSize - sizeof(TDbfShmHeader))
+            {
+                CDbfShm::Unmap(pData, nSize);
+                continue;
+            }
+            if (Attach(pData + sizeof(TDbfShmHeader), (size_t)pHeader->nImageSize))
+            {
+                // ԭ汾
+                CDbfShm::Unmap(pData, nSize);
+                if (m_pData)
+                {
+                    Attach(m_pData + sizeof(TDbfShmHeader), (size_t)((const TDbfShmHeader*)m_pData)->nImageSize);
+                }
+                return CIDbf::DBF_FILE_ERROR;
+            }
+            CDbfShm::Unmap(m_pData, m_nDataSize);
+            m_pData = pData;
+            m_nDataSize = nSize;
+            m_nVersion = nVersion;
+            return CIDbf::DBF_SUCC;
+        }
+        return CIDbf::DBF_FILE_ERROR;
+    }
+
+private:
+    // 
+    std::string m_strName;
+    // ƶ
+    TDbfShmControl* m_pControl;
+    // ǰݶ
+    char* m_pData;
+    size_t m_nDataSize;
+    // ǰ汾
+    unsigned long long m_nVersion;
+};
+
+#endif
@@ -0,0 +1,593 @@
+/*
+ * Copyright 2020 Arbboter email:arbboter@gmail.com
+ *
+ *     #    ######  ######  ######  ####### ####### ####### ######  
+ *    # #   #     # #     # #     # #     #    #    #       #     # 
+ *   #   #  #     # #     # #     # #     #    #    #       #     # 
+ *  #     # ######  ######  ######  #     #    #    #####   ######  
+ *  ####### #   #   #     # #     # #     #    #    #       #   #   
+ *  #     # #    #  #     # #     # #     #    #    #       #    #  
+ *  #     # #     # ######  ######  #######    #    ####### #     # 
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __P_DBF_SORT_H__
+#define __P_DBF_SORT_H__
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "PDbf.h"
+
+// ֶ
+class TDbfSortKey
+{
+public:
+    // ֶ
+    std::string strName;
+    // Ƿ
+    bool bDesc;
+
+    TDbfSortKey(const std::string& strKeyName = "", bool bKeyDesc = false)
+    {
+        strName = strKeyName;
+        bDesc = bKeyDesc;
+    }
+};
+
+// DBFļⲿ鲢
+// ڴ޷ֿȡ¼ỵ̴ָ̈߳߳ԭʼֶȡ淶Ƽ
+// (ַͰԭʼֽڣֵתΪɰֽڱȽϵ8ֽڴ˱룬ʱλȡ)
+// Լ󽫼¼дΣڴŲʱÿĸ߳̽ڴй鲢Ϊһдʱļ
+// ʱļm_nMaxMergeʱֶ˹鲢һ˶·鲢˳дļ
+// ȶͬļ¼ԭ˳
+class CDbfSort
+{
+public:
+    CDbfSort()
+    {
+        m_nMemLimit = 256 * 1024 * 1024;
+        m_nThreadNum = MMax(std::thread::hardware_concurrency(), 1U);
+        m_nIoBufSize = 4 * 1024 * 1024;
+        m_nMaxMerge = 64;
+        m_nRunNum = 0;
+        m_nTempSeq = 0;
+        m_nKeyLen = 0;
+        m_nRecLen = 0;
+    }
+
+    // ļvecKeyΪֶΣֶǰ'-'ʾ
+    int SortFile(const std::string& strIn, const std::string& strOut, const std::vector<std::string>& vecKey)
+    {
+        std::vector<TDbfSortKey> vecSortKey;
+        for (size_t i = 0; i < vecKey.size(); i++)
+        {
+            bool bDesc = !vecKey[i].empty() && vecKey[i][0] == '-';
+            vecSortKey.push_back(TDbfSortKey(bDesc ? vecKey[i].substr(1) : vecKey[i], bDesc));
+        }
+        return SortFile(strIn, strOut, vecSortKey);
+    }
+    int SortFile(const std::string& strIn, const std::string& strOut, const std::vector<TDbfSortKey>& vecKey)
+    {
+        m_nRunNum = 0;
+        if (strIn == strOut || vecKey.empty())
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        CPDbf oDbf;
+        if (oDbf.Open(strIn))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        if (InitKey(oDbf, vecKey))
+        {
+            return CIDbf::DBF_PARA_ERROR;
+        }
+        m_strTemp = TempPrefix(strOut);
+        m_nTempSeq = 0;
+        // ļͷԭ
+        TDbfHeader oHeader = oDbf.GetHeader();
+        std::vector<char> vecHead(oHeader.nHeaderLen + CPDbf::GetRemarkSize(oHeader.cVer));
+        if (ReadHead(strIn, vecHead))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+
+        // ÿ¼ռã + λ +  + 
+        size_t nRecNum = oDbf.GetRecNum();
+        size_t nPerRec = m_nRecLen * 2 + m_nKeyLen + sizeof(unsigned int);
+        size_t nChunk = MMax(m_nMemLimit / nPerRec, (size_t)m_nThreadNum);
+        nChunk = MMin(nChunk, (size_t)0xFFFFFFFF);
+        bool bSpill = nRecNum > nChunk;
+
+        std::vector<TRun> vecRun;
+        std::vector<char> vecSorted;
+        int nRet = CIDbf::DBF_SUCC;
+        for (size_t nRecNo = 0; nRecNo < nRecNum && nRet == CIDbf::DBF_SUCC; nRecNo += nChunk)
+        {
+            size_t nNum = MMin(nChunk, nRecNum - nRecNo);
+            if (oDbf.Read(nRecNo, nNum))
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+                break;
+            }
+            nRet = SortChunk(oDbf.ReadData(0), nNum, bSpill, vecSorted, vecRun);
+        }
+        oDbf.Close();
+        m_nRunNum = vecRun.size();
+
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = MergePass(vecRun);
+        }
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = Merge(vecRun, vecHead, strOut);
+        }
+        // ʱļ
+        for (size_t i = 0; i < vecRun.size(); i++)
+        {
+            CloseRun(vecRun[i]);
+        }
+        return nRet;
+    }
+
+public:
+    // ڴ(ֽ)ʱдʱļ
+    size_t m_nMemLimit;
+    // ߳
+    unsigned int m_nThreadNum;
+    // С
+    size_t m_nIoBufSize;
+    // ÿ˹鲢ʱļͬʱ򿪵ļ
+    size_t m_nMaxMerge;
+    // ʱļĿ¼ΪʱļͬĿ¼
+    std::string m_strTempDir;
+    // ϴֿ(дʱļʱÿһ)
+    size_t m_nRunNum;
+
+private:
+    // ֶ
+    class TKeyField
+    {
+    public:
+        size_t nPosition;
+        size_t nLength;
+        bool bNumeric;
+        bool bDesc;
+    };
+    // Σڴлʱļ
+    class TRun
+    {
+    public:
+        FILE* pFile;
+        std::string strFile;
+        // ʣδ뻺ļ¼
+        size_t nLeft;
+        // ļ¼
+        const char* pData;
+        size_t nPos;
+        size_t nNum;
+        std::vector<char> vecBuf;
+        // ǰ¼ļ
+        std::vector<unsigned char> vecKey;
+
+        TRun()
+        {
+            pFile = NULL;
+            nLeft = 0;
+            pData = NULL;
+            nPos = 0;
+            nNum = 0;
+        }
+    };
+    // 鲢ѱȽϣͬʱκСȣ֤ȶ
+    class CRunGreater
+    {
+    public:
+        CRunGreater(std::vector<TRun>& vecRun, size_t nKeyLen)
+            : m_vecRun(vecRun), m_nKeyLen(nKeyLen)
+        {
+        }
+        bool operator()(size_t a, size_t b) const
+        {
+            int nCmp = memcmp(&m_vecRun[a].vecKey[0], &m_vecRun[b].vecKey[0], m_nKeyLen);
+            return nCmp != 0 ? nCmp > 0 : a > b;
+        }
+    private:
+        std::vector<TRun>& m_vecRun;
+        size_t m_nKeyLen;
+    };
+
+    int InitKey(CPDbf& oDbf, const std::vector<TDbfSortKey>& vecKey)
+    {
+        std::vector<TDbfField> vecField = oDbf.GetField();
+        m_vecKey.clear();
+        m_nKeyLen = 0;
+        m_nRecLen = oDbf.GetRecLen();
+        for (size_t i = 0; i < vecKey.size(); i++)
+        {
+            size_t j = CPDbf::FindField(vecField, vecKey[i].strName);
+            if (j == vecField.size())
+            {
+                return CIDbf::DBF_PARA_ERROR;
+            }
+            TKeyField oKey;
+            oKey.nPosition = vecField[j].nPosition;
+            oKey.nLength = vecField[j].cLength;
+            oKey.bNumeric = vecField[j].cType == 'N' || vecField[j].cType == 'F';
+            oKey.bDesc = vecKey[i].bDesc;
+            m_vecKey.push_back(oKey);
+            m_nKeyLen += oKey.bNumeric ? sizeof(unsigned long long) : oKey.nLength;
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ȡ淶ֽڱȽϼΪ˳
+    void MakeKey(const char* pRec, unsigned char* pKey) const
+    {
+        for (size_t i = 0; i < m_vecKey.size(); i++)
+        {
+            const TKeyField& oKey = m_vecKey[i];
+            size_t nLen = oKey.nLength;
+            if (oKey.bNumeric)
+            {
+                double fValue = CDbfFastParse::ToDouble(pRec + oKey.nPosition, oKey.nLength);
+                unsigned long long nBits = 0;
+                memcpy(&nBits, &fValue, sizeof(nBits));
+                // ȫȡתλ
+                nBits = (nBits >> 63) ? ~nBits : (nBits | (1ULL << 63));
+                nLen = sizeof(nBits);
+                for (size_t k = 0; k < nLen; k++)
+                {
+                    pKey[k] = (unsigned char)(nBits >> (56 - 8 * k));
+                }
+            }
+            else
+            {
+                memcpy(pKey, pRec + oKey.nPosition, nLen);
+            }
+            if (oKey.bDesc)
+            {
+                for (size_t k = 0; k < nLen; k++)
+                {
+                    pKey[k] = (unsigned char)~pKey[k];
+                }
+            }
+            pKey += nLen;
+        }
+    }
+
+    int ReadHead(const std::string& strIn, std::vector<char>& vecHead)
+    {
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strIn.c_str(), "rb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nRead = fread(&vecHead[0], 1, vecHead.size(), pFile);
+        fclose(pFile);
+        return nRead == vecHead.size() ? CIDbf::DBF_SUCC : CIDbf::DBF_FILE_ERROR;
+    }
+
+    // ֿ򣬿ڰ̷ֶ߳򣬲дʱļʱÿΪһڴΣ
+    // ڴй鲢Ϊһκдһʱļ
+    int SortChunk(const char* pData, size_t nNum, bool bSpill, std::vector<char>& vecSorted, std::vector<TRun>& vecRun)
+    {
+        size_t nThread = MMin(MMax((size_t)m_nThreadNum, (size_t)1), nNum);
+        size_t nStep = (nNum + nThread - 1) / nThread;
+        // дʱļʱαvecSortedУֻһ
+        vecSorted.resize(nNum * m_nRecLen);
+        std::vector<TRun> vecSlice(nThread);
+        std::vector<std::thread> vecThread;
+        for (size_t t = 0; t < nThread; t++)
+        {
+            size_t nBegin = t * nStep;
+            vecSlice[t].nNum = nBegin < nNum ? MMin(nStep, nNum - nBegin) : 0;
+            vecThread.push_back(std::thread(&CDbfSort::SortRun, this, pData + nBegin * m_nRecLen,
+                &vecSorted[0] + nBegin * m_nRecLen, &vecSlice[t]));
+        }
+        for (size_t t = 0; t < vecThread.size(); t++)
+        {
+            vecThread[t].join();
+        }
+        if (!bSpill)
+        {
+            vecRun.insert(vecRun.end(), vecSlice.begin(), vecSlice.end());
+            return CIDbf::DBF_SUCC;
+        }
+        vecRun.push_back(TRun());
+        int nRet = NewRun(vecRun.back());
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = MergeRuns(vecSlice, 0, vecSlice.size(), vecRun.back(), 0);
+        }
+        return nRet;
+    }
+
+    // һμ¼дpOutΪڴ
+    void SortRun(const char* pData, char* pOut, TRun* pRun)
+    {
+        size_t nNum = pRun->nNum;
+        std::vector<unsigned char> vecKey(nNum * m_nKeyLen + 1);
+        std::vector<unsigned int> vecIdx(nNum);
+        for (size_t i = 0; i < nNum; i++)
+        {
+            MakeKey(pData + i * m_nRecLen, &vecKey[i * m_nKeyLen]);
+            vecIdx[i] = (unsigned int)i;
+        }
+        CKeyLess oLess(&vecKey[0], m_nKeyLen);
+        std::sort(vecIdx.begin(), vecIdx.end(), oLess);
+        for (size_t i = 0; i < nNum; i++)
+        {
+            memcpy(pOut + i * m_nRecLen, pData + (size_t)vecIdx[i] * m_nRecLen, m_nRecLen);
+        }
+        pRun->pData = pOut;
+    }
+    // Ƚϣͬʱԭ˳
+    class CKeyLess
+    {
+    public:
+        CKeyLess(const unsigned char* pKey, size_t nKeyLen)
+            : m_pKey(pKey), m_nKeyLen(nKeyLen)
+        {
+        }
+        bool operator()(unsigned int a, unsigned int b) const
+        {
+            int nCmp = memcmp(m_pKey + (size_t)a * m_nKeyLen, m_pKey + (size_t)b * m_nKeyLen, m_nKeyLen);
+            return nCmp != 0 ? nCmp < 0 : a < b;
+        }
+    private:
+        const unsigned char* m_pKey;
+        size_t m_nKeyLen;
+    };
+
+    // ȡεһ¼Ѷ귵false
+    bool Next(TRun& oRun)
+    {
+        if (oRun.nPos >= oRun.nNum)
+        {
+            if (!oRun.pFile || oRun.nLeft == 0)
+            {
+                return false;
+            }
+            size_t nNum = MMin(oRun.nLeft, oRun.vecBuf.size() / m_nRecLen);
+            if (fread(&oRun.vecBuf[0], 1, nNum * m_nRecLen, oRun.pFile) != nNum * m_nRecLen)
+            {
+                return false;
+            }
+            oRun.pData = &oRun.vecBuf[0];
+            oRun.nPos = 0;
+            oRun.nNum = nNum;
+            oRun.nLeft -= nNum;
+        }
+        MakeKey(oRun.pData + oRun.nPos * m_nRecLen, &oRun.vecKey[0]);
+        return true;
+    }
+
+    // ½ʱļΣдرգ鲢ʱٴ򿪣ͬʱ򿪵ļ鲢·
+    int NewRun(TRun& oRun)
+    {
+        char szName[64];
+        sprintf_s(szName, ".%zu.tmp", m_nTempSeq++);
+        oRun.strFile = m_strTemp + szName;
+        if (ws_fopen(&oRun.pFile, oRun.strFile.c_str(), "wb+"))
+        {
+            oRun.pFile = NULL;
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        return CIDbf::DBF_SUCC;
+    }
+    // رղɾεʱļ
+    void CloseRun(TRun& oRun)
+    {
+        if (oRun.pFile)
+        {
+            fclose(oRun.pFile);
+            oRun.pFile = NULL;
+        }
+        if (!oRun.strFile.empty())
+        {
+            remove(oRun.strFile.c_str());
+            oRun.strFile.clear();
+        }
+    }
+
+    // ʱļζm_nMaxMergeʱ˳ÿm_nMaxMerge鲢ΪһֱΪֹ
+    // ڵĶκϲεȺ˳򲻱䣬Ȼȶ
+    int MergePass(std::vector<TRun>& vecRun)
+    {
+        size_t nWay = MMax(m_nMaxMerge, (size_t)2);
+        while (vecRun.size() > nWay)
+        {
+            std::vector<TRun> vecNext;
+            int nRet = CIDbf::DBF_SUCC;
+            for (size_t i = 0; i < vecRun.size(); i += nWay)
+            {
+                size_t nEnd = MMin(i + nWay, vecRun.size());
+                vecNext.push_back(TRun());
+                if (nRet == CIDbf::DBF_SUCC && nEnd - i == 1)
+                {
+                    std::swap(vecNext.back(), vecRun[i]);
+                    continue;
+                }
+                if (nRet == CIDbf::DBF_SUCC)
+                {
+                    nRet = NewRun(vecNext.back());
+                }
+                if (nRet == CIDbf::DBF_SUCC)
+                {
+                    nRet = MergeRuns(vecRun, i, nEnd, vecNext.back(), RunBufSize(nEnd - i));
+                }
+                // ѹ鲢ɾռò
+                for (size_t k = i; k < nEnd; k++)
+                {
+                    CloseRun(vecRun[k]);
+                }
+            }
+            vecRun.swap(vecNext);
+            if (nRet)
+            {
+                return nRet;
+            }
+        }
+        return CIDbf::DBF_SUCC;
+    }
+
+    // ÿʱļεĶ棬nWayƽڴޣһ¼
+    size_t RunBufSize(size_t nWay) const
+    {
+        return MMax(m_nMemLimit / (nWay + 1) / m_nRecLen, (size_t)1) * m_nRecLen;
+    }
+
+    // 鲢vecRun[nBegin, nEnd)ΣдoOutʱļ
+    int MergeRuns(std::vector<TRun>& vecRun, size_t nBegin, size_t nEnd, TRun& oOut, size_t nRunBuf)
+    {
+        size_t nNum = 0;
+        int nRet = MergeTo(vecRun, nBegin, nEnd, oOut.pFile, nRunBuf, nNum);
+        if (fclose(oOut.pFile))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        oOut.pFile = NULL;
+        oOut.nLeft = nNum;
+        return nRet;
+    }
+
+    // ·鲢[nBegin, nEnd)Σ¼˳дpFilenNumдļ¼
+    int MergeTo(std::vector<TRun>& vecRun, size_t nBegin, size_t nEnd, FILE* pFile, size_t nRunBuf, size_t& nNum)
+    {
+        std::vector<size_t> vecHeap;
+        for (size_t i = nBegin; i < nEnd; i++)
+        {
+            TRun& oRun = vecRun[i];
+            oRun.vecKey.resize(m_nKeyLen + 1);
+            if (!oRun.strFile.empty())
+            {
+                if (ws_fopen(&oRun.pFile, oRun.strFile.c_str(), "rb"))
+                {
+                    oRun.pFile = NULL;
+                    return CIDbf::DBF_FILE_ERROR;
+                }
+                oRun.vecBuf.resize(MMin(nRunBuf, oRun.nLeft * m_nRecLen));
+            }
+            if (Next(oRun))
+            {
+                vecHeap.push_back(i);
+            }
+        }
+        CRunGreater oGreater(vecRun, m_nKeyLen);
+        std::make_heap(vecHeap.begin(), vecHeap.end(), oGreater);
+
+        int nRet = CIDbf::DBF_SUCC;
+        std::vector<char> vecOut(MMax(m_nIoBufSize / m_nRecLen, (size_t)1) * m_nRecLen);
+        size_t nOut = 0;
+        nNum = 0;
+        while (!vecHeap.empty() && nRet == CIDbf::DBF_SUCC)
+        {
+            std::pop_heap(vecHeap.begin(), vecHeap.end(), oGreater);
+            TRun& oRun = vecRun[vecHeap.back()];
+            memcpy(&vecOut[nOut], oRun.pData + oRun.nPos * m_nRecLen, m_nRecLen);
+            nOut += m_nRecLen;
+            nNum++;
+            oRun.nPos++;
+            if (Next(oRun))
+            {
+                std::push_heap(vecHeap.begin(), vecHeap.end(), oGreater);
+            }
+            else
+            {
+                vecHeap.pop_back();
+            }
+            // ʱһд
+            if (nOut == vecOut.size() || vecHeap.empty())
+            {
+                if (fwrite(&vecOut[0], 1, nOut, pFile) != nOut)
+                {
+                    nRet = CIDbf::DBF_FILE_ERROR;
+                }
+                nOut = 0;
+            }
+        }
+        // ʱļζȡʧʱǰգʣ¼
+        for (size_t i = nBegin; i < nEnd && nRet == CIDbf::DBF_SUCC; i++)
+        {
+            if (vecRun[i].nLeft || vecRun[i].nPos < vecRun[i].nNum)
+            {
+                nRet = CIDbf::DBF_FILE_ERROR;
+            }
+        }
+        return nRet;
+    }
+
+    // һ˶·鲢дļ
+    int Merge(std::vector<TRun>& vecRun, const std::vector<char>& vecHead, const std::string& strOut)
+    {
+        FILE* pFile = NULL;
+        if (ws_fopen(&pFile, strOut.c_str(), "wb"))
+        {
+            return CIDbf::DBF_FILE_ERROR;
+        }
+        int nRet = CIDbf::DBF_SUCC;
+        if (fwrite(&vecHead[0], 1, vecHead.size(), pFile) != vecHead.size())
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        size_t nNum = 0;
+        if (nRet == CIDbf::DBF_SUCC)
+        {
+            nRet = MergeTo(vecRun, 0, vecRun.size(), pFile, RunBufSize(vecRun.size()), nNum);
+        }
+        // ļ־
+        const char cEndFlag = 0x1A;
+        if (nRet == CIDbf::DBF_SUCC && fwrite(&cEndFlag, 1, 1, pFile) != 1)
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        if (fclose(pFile))
+        {
+            nRet = CIDbf::DBF_FILE_ERROR;
+        }
+        return nRet;
+    }
+
+    // ʱļǰ׺̺żţͬһĿ¼ʱͻ
+    std::string TempPrefix(const std::string& strOut) const
+    {
+        static std::atomic<unsigned int> s_nSeq(0);
+        char szId[64];
+#ifdef _WIN32
+        sprintf_s(szId, ".sort%lu_%u", (unsigned long)GetCurrentProcessId(), s_nSeq++);
+#else
+        sprintf_s(szId, ".sort%lu_%u", (unsigned long)getpid(), s_nSeq++);
+#endif
+        if (m_strTempDir.empty())
+        {
+            return strOut + szId;
+        }
+        size_t nPos = strOut.find_last_of("/\\");
+        std::string strName = nPos == std::string::npos ? strOut : strOut.substr(nPos + 1);
+        return m_strTempDir + "/" + strName + szId;
+    }
+
+private:
+    std::vector<TKeyField> m_vecKey;
+    // ʱļǰ׺
+    std::string m_strTemp;
+    size_t m_nTempSeq;
+    // 淶
+    size_t m_nKeyLen;
+    // ¼
+    size_t m_nRecLen;
+};
+
+#endif